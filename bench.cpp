@@ -0,0 +1,111 @@
+#include "include/Network.hpp"
+#include "include/Dataset.hpp"
+#include "include/Matrix.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// Compares one training epoch of a deep stack run three ways: the plain
+// sequential forward/backprop/step loop, data-parallel replicas and layer
+// pipelining.
+//
+//     ./build/bench [threads] [hidden layers] [width] [batch size]
+
+static std::vector<Layer> make_layers(size_t depth, size_t width, size_t classes)
+{
+    std::vector<Layer> layers;
+    for (size_t i = 0; i < depth; i++)
+    {
+        layers.emplace_back(width, width, Activation::RELU);
+    }
+    layers.emplace_back(width, classes, Activation::SOFTMAX);
+    return layers;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    const size_t depth = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+    const size_t width = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256;
+    const size_t batch_size = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 128;
+    const size_t samples = 16 * batch_size;
+    const size_t classes = 10;
+    const size_t epochs = 3;
+
+    std::mt19937 gen(42);
+    std::normal_distribution<double> value(0.0, 1.0);
+    std::uniform_int_distribution<size_t> label(0, classes - 1);
+
+    Matrix inputs(samples, width);
+    std::vector<size_t> outputs(samples);
+    for (size_t i = 0; i < samples; i++)
+    {
+        for (size_t j = 0; j < width; j++) inputs.set(i, j, value(gen));
+        outputs[i] = label(gen);
+    }
+    Dataset dataset(inputs, outputs);
+
+    std::cout << depth << " x " << width << " hidden layers, batch " << batch_size
+              << ", " << samples << " samples, " << threads << " threads" << std::endl;
+
+    // Sequential reference: one thread, the plain per-batch loop
+    {
+        Network network(make_layers(depth, width, classes), 0.01, InitType::He);
+        network.reserve_batch(batch_size);
+        Matrix batch(width, batch_size);
+        std::vector<size_t> labels(batch_size);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t epoch = 0; epoch < epochs; epoch++)
+        {
+            for (size_t first = 0; first < samples; first += batch_size)
+            {
+                dataset.get_batch(first, batch);
+                for (size_t j = 0; j < batch_size; j++) labels[j] = dataset.get_output(first + j);
+
+                network.forward(batch);
+                network.backprop(labels.data());
+                network.step(0.01);
+            }
+        }
+        const double elapsed = seconds_since(start);
+        std::cout << std::left << std::setw(16) << "sequential" << std::fixed << std::setprecision(1)
+                  << epochs * samples / elapsed << " samples/s" << std::endl;
+    }
+
+    const std::pair<const char*, TrainStrategy> strategies[] = {
+        { "data-parallel", TrainStrategy::SYNCHRONOUS },
+        { "pipeline", TrainStrategy::PIPELINE },
+    };
+
+    for (const auto& s : strategies)
+    {
+        Network network(make_layers(depth, width, classes), 0.01, InitType::He);
+        // Never counts as an improvement, so no checkpoints are written
+        network.set_min_delta(2.0);
+        network.set_num_threads(threads);
+        network.set_strategy(s.second);
+
+        // train() draws its progress graph; keep it out of the report
+        std::ostringstream discard;
+        std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+
+        auto start = std::chrono::steady_clock::now();
+        network.train(dataset, epochs - 1, batch_size);
+        const double elapsed = seconds_since(start);
+
+        std::cout.rdbuf(console);
+        std::cout << std::left << std::setw(16) << s.first << std::fixed << std::setprecision(1)
+                  << epochs * samples / elapsed << " samples/s" << std::endl;
+    }
+
+    return 0;
+}
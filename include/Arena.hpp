@@ -0,0 +1,62 @@
+// arena.hpp
+
+#pragma once
+#include "Precision.hpp"
+#include <cstddef>
+
+// Cache-line alignment, which also covers the widest SIMD register.
+constexpr size_t ALIGNMENT = 64;
+
+// Arenas at least this large are backed by transparent huge pages.
+constexpr size_t HUGE_PAGE_THRESHOLD = 2 * 1024 * 1024;
+
+void* aligned_allocate(size_t bytes);
+void aligned_free(void* ptr);
+
+template <class T>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(aligned_allocate(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t) { aligned_free(ptr); }
+
+    template <class U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+// A single aligned block carved into Scalar buffers with a bump pointer.
+// Every buffer starts on a cache line. Owners size it once up front with
+// footprint() and never grow it, so buffers stay put for its lifetime.
+class Arena
+{
+    private:
+        Scalar* base;
+        size_t capacity_bytes;
+        size_t used_bytes;
+        bool mapped;
+
+        void release();
+
+    public:
+        Arena();
+        explicit Arena(size_t bytes);
+        ~Arena();
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        Arena(Arena&& other) noexcept;
+        Arena& operator=(Arena&& other) noexcept;
+
+        // Bytes an allocation of count Scalars takes, padding included
+        static size_t footprint(size_t count);
+
+        Scalar* allocate(size_t count);
+
+        size_t capacity() const { return capacity_bytes; }
+        size_t used() const { return used_bytes; }
+        bool huge_pages() const { return mapped; }
+};
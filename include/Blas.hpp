@@ -0,0 +1,28 @@
+// blas.hpp
+
+#pragma once
+#include "Gemm.hpp"
+#include <cstddef>
+
+// Backend for Matrix products. Built with BLAS=<vendor> (see the
+// Makefile) it forwards GEMM and matrix-vector products to that cblas;
+// otherwise, or when the library was not found at build time, it runs
+// the in-tree gemm engine. Arguments follow gemm::gemm; a vendor library
+// runs the epilogue as one pass over C after its product.
+namespace blas
+{
+    // "openblas", "blis", "accelerate", "cblas" or "builtin"
+    const char* backend();
+
+    void gemm(gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+              float alpha, const float* A, size_t lda,
+              const float* B, size_t ldb,
+              float beta, float* C, size_t ldc,
+              const gemm::Epilogue<float>& epilogue = {});
+
+    void gemm(gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+              double alpha, const double* A, size_t lda,
+              const double* B, size_t ldb,
+              double beta, double* C, size_t ldc,
+              const gemm::Epilogue<double>& epilogue = {});
+}
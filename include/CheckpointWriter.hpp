@@ -0,0 +1,52 @@
+// checkpointwriter.hpp
+
+#pragma once
+#include "ModelIO.hpp"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Network;
+
+// Writes checkpoints on a background thread so training never waits on
+// disk. publish() copies the network into whichever of two snapshot
+// buffers the writer is not using and returns; the writer thread then
+// serializes it with ModelIO::write_snapshot (temp file, fsync, atomic
+// rename). A snapshot published while an older one is still waiting
+// replaces it, so only the latest state is written. Write errors are
+// rethrown from the next publish() or flush().
+class CheckpointWriter
+{
+    private:
+        ModelIO::Snapshot buffers[2];
+        std::string paths[2];
+
+        // Index training fills next; the writer only reads the other one
+        size_t spare = 0;
+        bool pending = false;
+        bool writing = false;
+        bool stopping = false;
+        std::exception_ptr error;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::thread thread;
+
+        void run();
+        void rethrow_error();
+
+    public:
+        CheckpointWriter();
+        // Finishes any pending write
+        ~CheckpointWriter();
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        void publish(const Network& network, const std::string& filepath);
+        // Blocks until every published snapshot is on disk
+        void flush();
+};
@@ -0,0 +1,107 @@
+// dataloader.hpp
+
+#pragma once
+#include "Dataset.hpp"
+#include "Matrix.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Assembles mini-batches ahead of the trainer. Producer threads walk a
+// freshly shuffled order of the dataset each epoch and gather every batch
+// into a contiguous, cache-aligned features x batch matrix with its
+// labels, optionally standardizing each feature, into a bounded ring of
+// slots. The trainer takes ready batches in order and hands each back
+// with release(); production runs ahead into the next epoch (shuffle
+// included), so the trainer only waits if the producers fall behind.
+//
+//     DataLoader loader(dataset, 32);
+//     for (...) {
+//         loader.begin_epoch();
+//         DataLoader::Batch batch;
+//         while (loader.next(batch)) { ...; loader.release(batch); }
+//     }
+//
+// next() and release() may be called from several threads at once. The
+// dataset must outlive the loader and not change while it runs.
+class DataLoader
+{
+    public:
+        struct Batch
+        {
+            ConstMatrixView input;      // features x samples, contiguous
+            const size_t* labels;       // one per column of input
+            size_t slot;
+        };
+
+    private:
+        enum class SlotState { Free, Filling, Ready, InUse };
+
+        struct Slot
+        {
+            Matrix input;
+            std::vector<size_t> labels;
+            SlotState state = SlotState::Free;
+            size_t sequence = 0;
+            size_t count = 0;
+        };
+
+        const Dataset& dataset;
+        size_t batch_size;
+        size_t batches_per_epoch;
+
+        // Per-feature (x - mean) * inv_std applied while gathering
+        bool standardize;
+        std::vector<Scalar> mean;
+        std::vector<Scalar> inv_std;
+
+        // Shuffled sample order of epochs e (even) and e + 1 (odd). An
+        // epoch's order is rebuilt once no gather from two epochs back
+        // still reads it.
+        std::vector<size_t> order[2];
+        size_t active[2] = { 0, 0 };
+        size_t prepared_epochs = 0;
+        bool shuffling = false;
+        std::mt19937 rng;
+
+        std::vector<Slot> slots;
+        size_t next_fill = 0;           // sequence number producers claim next
+        size_t next_take = 0;           // sequence number next() hands out next
+        size_t epoch_end = 0;           // next() stops here until begin_epoch()
+
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::thread> producers;
+
+        void produce();
+        void gather(Slot& slot, const std::vector<size_t>& epoch_order, size_t batch);
+        void compute_statistics();
+
+    public:
+        // prefetch is the number of batch slots (ready, in flight or in
+        // use); give several concurrent consumers at least one each plus
+        // one to fill
+        DataLoader(const Dataset& dataset, size_t batch_size, size_t prefetch = 2,
+                   size_t threads = 1, bool standardize = false);
+        ~DataLoader();
+
+        DataLoader(const DataLoader&) = delete;
+        DataLoader& operator=(const DataLoader&) = delete;
+
+        size_t size() const { return dataset.size(); }
+        size_t features() const { return dataset.features(); }
+        size_t get_batch_size() const { return batch_size; }
+        size_t batches() const { return batches_per_epoch; }
+
+        // Makes the next epoch's batches available to next(). The previous
+        // epoch must have been handed out completely.
+        void begin_epoch();
+        // Waits for the next batch of the current epoch; false once every
+        // batch of the epoch has been handed out
+        bool next(Batch& batch);
+        void release(const Batch& batch);
+};
@@ -8,19 +8,30 @@
 class Dataset 
 {
     private:   
-        std::vector<Matrix> inputs;
+        // One sample per row, handed out as a features x 1 view of its row
+        Matrix inputs;
         std::vector<size_t> outputs;
 
         std::vector<size_t> perm_idx;
 
     public:
-        Dataset(std::vector<Matrix> inputs, std::vector<size_t> outputs);
+        Dataset(const std::vector<Matrix>& inputs, std::vector<size_t> outputs);
+        // inputs is samples x features
+        Dataset(Matrix inputs, std::vector<size_t> outputs);
 
         const size_t size() const;
+        size_t features() const;
 
-        const Matrix& get_input(size_t index) const;
+        ConstMatrixView get_input(size_t index) const;
+        // Gathers samples start .. start + out.cols() (in shuffled order)
+        // into the columns of out, which is features x batch
+        void get_batch(size_t start, MatrixView out) const;
         const size_t get_output(size_t index) const;
 
+        // Storage order, ignoring shuffle(): the features of row and its label
+        const Scalar* sample(size_t row) const;
+        size_t label(size_t row) const;
+
         void shuffle();
         
         static Dataset from_csv(
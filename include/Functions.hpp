@@ -15,7 +15,22 @@ enum class Activation {
     SOFTMAX
 };
 
+enum class OptimizerType {
+    SGD_MOMENTUM,
+    NESTEROV,
+    ADAM,
+    ADAMW,
+    RMSPROP
+};
+
 enum class Loss {
     MSE,
     CROSS_ENTROPY
+};
+
+// How train() uses several threads (see Network::set_num_threads)
+enum class TrainStrategy {
+    SYNCHRONOUS,    // split each batch, reduce gradients, one shared step
+    HOGWILD,        // independent batches, lock-free steps on shared weights
+    PIPELINE        // layers as stages on their own threads, micro-batches flowing through
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+// gemm.hpp
+
+#pragma once
+#include <cstddef>
+
+// General matrix multiply on row-major storage:
+//     C = alpha * op(A) * op(B) + beta * C
+// where op(X) is X or X^T. op(A) is M x K, op(B) is K x N and C is M x N;
+// lda and ldb are the leading dimensions of A and B as stored. When beta
+// is 0, C is never read. Transposed operands are read in place while
+// packing, so they are never materialized.
+namespace gemm
+{
+    enum class Trans { No, Yes };
+
+    enum class Activation { Linear, Relu };
+
+    // Work folded into the final store of C, while each finished tile is
+    // still in cache: C += bias (one value per row of C), then, when out
+    // is set, out = f(C) with rows of out ldo elements apart. A plain
+    // product leaves everything at its default.
+    template <class T>
+    struct Epilogue
+    {
+        const T* bias = nullptr;
+        Activation activation = Activation::Linear;
+        T* out = nullptr;
+        size_t ldo = 0;
+
+        bool empty() const { return bias == nullptr && out == nullptr; }
+
+        // The same epilogue for the sub-block of C starting at (i, j)
+        Epilogue offset(size_t i, size_t j) const
+        {
+            Epilogue e = *this;
+            if (e.bias) e.bias += i;
+            if (e.out) e.out += i * ldo + j;
+            return e;
+        }
+    };
+
+    // Register tile of the portable micro-kernel. Products in Scalar use
+    // the active kernel table's instead, sized for its vector registers
+    // (see kernels::GemmKernel).
+    constexpr size_t MR = 4;
+    constexpr size_t NR = 8;
+
+    // Cache blocking: an MC x KC panel of A stays in L2, a KC x NR
+    // sliver of B stays in L1, a KC x NC panel of B stays in L3.
+    constexpr size_t MC = 96;
+    constexpr size_t KC = 256;
+    constexpr size_t NC = 2048;
+
+    // Problems with fewer multiply-adds than this skip packing.
+    constexpr size_t SMALL_THRESHOLD = 32 * 32 * 32;
+
+    // Problems with at least this many multiply-adds split C into tiles
+    // computed in parallel on ThreadPool::global().
+    constexpr size_t PARALLEL_THRESHOLD = 128 * 128 * 128;
+
+    // Threads used for large products (the shared pool's size). Defaults
+    // to CRNN_THREADS, or the hardware concurrency when unset.
+    void set_num_threads(size_t threads);
+    size_t num_threads();
+
+    void gemm(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+              float alpha, const float* A, size_t lda,
+              const float* B, size_t ldb,
+              float beta, float* C, size_t ldc,
+              const Epilogue<float>& epilogue = {});
+
+    void gemm(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+              double alpha, const double* A, size_t lda,
+              const double* B, size_t ldb,
+              double beta, double* C, size_t ldc,
+              const Epilogue<double>& epilogue = {});
+
+    // Applies an epilogue to an already computed M x N block of C, for
+    // backends that cannot run it inside the product.
+    void apply_epilogue(size_t M, size_t N, const Epilogue<float>& epilogue, float* C, size_t ldc);
+    void apply_epilogue(size_t M, size_t N, const Epilogue<double>& epilogue, double* C, size_t ldc);
+
+    // Straightforward triple loop, kept as a correctness reference.
+    void gemm_reference(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                        float alpha, const float* A, size_t lda,
+                        const float* B, size_t ldb,
+                        float beta, float* C, size_t ldc);
+
+    void gemm_reference(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                        double alpha, const double* A, size_t lda,
+                        const double* B, size_t ldb,
+                        double beta, double* C, size_t ldc);
+}
@@ -0,0 +1,49 @@
+// inferencemodel.hpp
+
+#pragma once
+#include "Arena.hpp"
+#include "InferenceSession.hpp"
+#include "ModelIO.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class Network;
+
+// A network reduced to what serving needs: each layer's shape and
+// activation, and its W and b in one flat block laid out like a
+// ParameterStore's parameters. There are no gradients, optimizer state or
+// per-layer activations; forward passes run in InferenceSessions on top,
+// each adding two ping-pong buffers for the widest layer. The weights
+// never change after construction, so any number of sessions can share a
+// model across threads.
+class InferenceModel
+{
+    private:
+        std::vector<ModelIO::LayerShape> shapes;
+        Arena memory;
+        Scalar* params;
+        size_t count;
+
+    public:
+        // Zeroed weights for the given layers
+        explicit InferenceModel(std::vector<ModelIO::LayerShape> layers);
+        // Copies network's current weights
+        explicit InferenceModel(const Network& network);
+        // Reads only the shapes and weights of a checkpoint; optimizer
+        // state and training settings are skipped on disk
+        static InferenceModel load(const std::string& filepath);
+
+        const std::vector<ModelIO::LayerShape>& get_layers() const { return shapes; }
+        size_t input_size() const { return shapes.front().input_size; }
+        size_t output_size() const { return shapes.back().output_size; }
+
+        size_t parameter_count() const { return count; }
+        Scalar* parameters() { return params; }
+        const Scalar* parameters() const { return params; }
+        // Resident bytes of the weights
+        size_t bytes() const { return memory.capacity(); }
+
+        // Views of each layer's W (output x input) and b (output x 1)
+        std::vector<InferenceSession::LayerWeights> weights() const;
+};
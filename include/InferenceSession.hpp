@@ -0,0 +1,60 @@
+// inferencesession.hpp
+
+#pragma once
+#include "Arena.hpp"
+#include "Functions.hpp"
+#include "Matrix.hpp"
+#include <cstddef>
+#include <vector>
+
+class Network;
+class InferenceModel;
+
+// Forward passes against weights owned elsewhere. A session holds only
+// activation scratch: two buffers sized for the widest layer, which the
+// layers write into alternately, each reading the one the layer before it
+// wrote. Nothing is written outside the session, so any number of
+// sessions (one per thread) can run on the same weights at once with no
+// locks and no copies, as long as nothing trains or reloads them meanwhile.
+class InferenceSession
+{
+    public:
+        // One dense layer of the shared weights: W is output x input and b
+        // is output x 1
+        struct LayerWeights
+        {
+            ConstMatrixView W;
+            ConstMatrixView b;
+            Activation activation;
+        };
+
+    private:
+        std::vector<LayerWeights> layers;
+        size_t width;
+
+        Arena arena;
+        Scalar* buffers[2];
+        size_t capacity;
+
+        void plan(size_t capacity);
+
+    public:
+        // Views network's weights in place, so later loads and training
+        // steps show through (between calls). A set_optimizer() that
+        // changes the state layout moves them; create sessions after it.
+        explicit InferenceSession(const Network& network, size_t capacity = 1);
+        explicit InferenceSession(const InferenceModel& model, size_t capacity = 1);
+        InferenceSession(std::vector<LayerWeights> layers, size_t capacity = 1);
+
+        size_t input_size() const { return layers.front().W.cols(); }
+        size_t output_size() const { return layers.back().W.rows(); }
+
+        // input is features x batch, one sample per column. The result is
+        // classes x batch and stays valid until the next call. Batches wider
+        // than the session's capacity grow it.
+        ConstMatrixView forward(ConstMatrixView input);
+        // Most probable class of a single sample
+        size_t predict(ConstMatrixView input);
+        // One label per column of input
+        void predict(ConstMatrixView input, size_t* labels);
+};
@@ -0,0 +1,118 @@
+// kernels.hpp
+
+#pragma once
+#include "Precision.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Element-wise Matrix kernels, compiled once per instruction set and
+// selected at startup from what the CPU reports (AVX-512, AVX2+FMA, SSE2,
+// or portable scalar code on other architectures). Setting CRNN_ISA to
+// one of the table names forces a specific (supported) table.
+namespace kernels
+{
+    // Int8 products take weights packed in panels of QUANT_BLOCK output
+    // channels. Within a panel, each group of four inputs k .. k + 3 holds
+    // channel 0's four weights, then channel 1's, and so on (4 *
+    // QUANT_BLOCK bytes), so one register holds a group for the whole
+    // panel. Channel and input counts are padded with zero weights to
+    // multiples of QUANT_BLOCK.
+    constexpr size_t QUANT_BLOCK = 16;
+
+    inline size_t quant_padded(size_t n) { return (n + QUANT_BLOCK - 1) / QUANT_BLOCK * QUANT_BLOCK; }
+
+    // Offset of weight (i, k) in a packed matrix of padded_inputs columns
+    inline size_t quant_index(size_t i, size_t k, size_t padded_inputs)
+    {
+        return (i / QUANT_BLOCK) * QUANT_BLOCK * padded_inputs + (k / 4) * 4 * QUANT_BLOCK +
+               (i % QUANT_BLOCK) * 4 + k % 4;
+    }
+
+    // Finishes the int32 results of a quantized product for a panel at a
+    // time, while they are still in registers: v = scale[i] * acc +
+    // bias[i], clamped at zero when relu is set. Then either out(i, j) = v
+    // (rows of out ldo apart), or, when qout is set, v is rounded,
+    // saturated to [-127, 127] and stored sample-major as
+    // qout[j * ldq + i], the next product's input. row_sums holds the sum
+    // of each weight row. Every array is padded to whole panels.
+    struct QuantEpilogue
+    {
+        const int32_t* row_sums = nullptr;
+        const float* scale = nullptr;
+        const float* bias = nullptr;
+        bool relu = false;
+
+        Scalar* out = nullptr;
+        size_t ldo = 0;
+        int8_t* qout = nullptr;
+        size_t ldq = 0;
+    };
+
+    // Register-tile micro-kernel of the packed GEMM (see Gemm.cpp): over kc
+    // steps, Ap holds mr values of A per step and Bp nr values of B, and
+    // the mr x nr tile of C (rows ldc apart) becomes beta * C + Ap * Bp.
+    // C is not read when beta is 0. Tiles are at most GEMM_TILE_MAX
+    // elements.
+    constexpr size_t GEMM_TILE_MAX = 512;
+
+    struct GemmKernel
+    {
+        size_t mr, nr;
+        void (*run)(size_t kc, const Scalar* Ap, const Scalar* Bp, Scalar beta, Scalar* C, size_t ldc);
+    };
+
+    struct KernelTable
+    {
+        const char* name;
+
+        void (*add)(const Scalar* a, const Scalar* b, Scalar* out, size_t n);
+        void (*sub)(const Scalar* a, const Scalar* b, Scalar* out, size_t n);
+        void (*mul)(const Scalar* a, const Scalar* b, Scalar* out, size_t n);
+        void (*scale)(const Scalar* a, Scalar s, Scalar* out, size_t n);
+        void (*axpy)(Scalar alpha, const Scalar* x, Scalar* y, size_t n);   // y += alpha * x
+
+        void (*relu)(const Scalar* a, Scalar* out, size_t n);
+        void (*drelu)(const Scalar* a, Scalar* out, size_t n);
+        void (*relu_backward)(const Scalar* grad, const Scalar* a, Scalar* out, size_t n);  // grad * drelu(a)
+        void (*exp)(const Scalar* a, Scalar* out, size_t n);
+
+        // Column-wise softmax of a row-major rows x cols matrix; rows of
+        // in and out are ld_in and ld_out elements apart
+        void (*softmax)(const Scalar* in, size_t ld_in, Scalar* out, size_t ld_out, size_t rows, size_t cols);
+
+        // Fused optimizer updates of n parameters p from gradients g,
+        // updating the optimizer state in place (see Optimizer.hpp)
+        void (*momentum_step)(Scalar* p, const Scalar* g, Scalar* v, size_t n, Scalar lr, Scalar beta);
+        void (*nesterov_step)(Scalar* p, const Scalar* g, Scalar* v, size_t n, Scalar lr, Scalar beta);
+        void (*adam_step)(Scalar* p, const Scalar* g, Scalar* m, Scalar* v, size_t n,
+                          Scalar step_size, Scalar beta1, Scalar beta2, Scalar epsilon, Scalar decay);
+        void (*rmsprop_step)(Scalar* p, const Scalar* g, Scalar* v, size_t n, Scalar lr, Scalar rho, Scalar epsilon);
+
+        // Int8 product with int32 accumulation: acc(i, j) is the dot product
+        // of row i of the packed M x K weights W and row j of X (N samples
+        // of K int8 values, ldx apart), i.e. W * X^T, finished by the
+        // epilogue. K is padded; values of X past the real inputs meet zero
+        // weights and may be anything.
+        void (*gemm_s8)(const int8_t* W, const int8_t* X, size_t ldx,
+                        size_t M, size_t N, size_t K, const QuantEpilogue& epilogue);
+
+        GemmKernel gemm;
+    };
+
+    const KernelTable& active();
+
+    namespace scalar { const KernelTable& table(); }
+
+#if defined(__x86_64__) || defined(_M_X64)
+    namespace sse2   { const KernelTable& table(); }
+    namespace avx2   { const KernelTable& table(); }
+    namespace avx512 { const KernelTable& table(); }
+    // The AVX-512 table with the int8 product on VNNI dot-product instructions
+    namespace avx512vnni
+    {
+        const KernelTable& table();
+        void gemm_s8(const int8_t* W, const int8_t* X, size_t ldx,
+                     size_t M, size_t N, size_t K, const QuantEpilogue& epilogue);
+    }
+#endif
+}
@@ -10,6 +10,9 @@ class Layer
         size_t input_size;
         size_t output_size;
 
+        // Columns A, Z, dA and dZ have room for; each column is one sample
+        size_t batch_capacity;
+
         Activation activation;
 
         Matrix A;
@@ -25,7 +28,7 @@ class Layer
         Matrix vb;
         Matrix vW;
 
-        const Matrix* prev_A;
+        ConstMatrixView prev_A;
         Matrix* prev_dA;
         
     public:
@@ -35,6 +38,20 @@ class Layer
         void init_weights(InitType init_type);
         void connect_prev(const Layer& prev);
 
+        // W followed by b; dW, db and vW, vb share that layout
+        size_t parameter_count() const;
+        // Moves W and b to params, dW and db to grads and vW and vb to
+        // velocity, each parameter_count() long, keeping their values
+        void bind_parameters(Scalar* params, Scalar* grads, Scalar* velocity);
+
+        // Bytes of Arena space bind() needs for batches of up to capacity samples
+        size_t workspace_size(size_t capacity = 1) const;
+        // Gives the activation buffers room for capacity samples in arena
+        void bind(Arena& arena, size_t capacity = 1);
+        // Number of samples (columns) the next forward pass processes
+        void set_batch(size_t batch);
+        size_t get_batch() const { return A.cols(); }
+
         // Getters
         const Matrix& getA() const;
         const Matrix& get_dA() const;
@@ -42,12 +59,14 @@ class Layer
 
         Matrix& getA();
         Matrix& get_dA();
+        Matrix& get_dZ();
 
         // Setters
-        void setA(const Matrix& g);
-        void set_dA(const Matrix& g);
-        void set_dZ(const Matrix& g);
-        void set_prev_A(const Matrix* prev_A_ptr);
+        // Setters copy into the existing buffers, whose shapes are fixed
+        void setA(ConstMatrixView g);
+        void set_dA(ConstMatrixView g);
+        void set_dZ(ConstMatrixView g);
+        void set_prev_A(ConstMatrixView input);
         
         // Model I/O getters
         size_t get_input_size() const { return input_size; }
@@ -59,17 +78,19 @@ class Layer
         const Matrix& getvb() const { return vb; }
         
         // Model I/O setters
-        void setW(const Matrix& w) { W = w; }
-        void setb(const Matrix& bias) { b = bias; }
-        void setvW(const Matrix& vw) { vW = vw; }
-        void setvb(const Matrix& vbias) { vb = vbias; }
+        void setW(ConstMatrixView w) { W.copy_from(w); }
+        void setb(ConstMatrixView bias) { b.copy_from(bias); }
+        void setvW(ConstMatrixView vw) { vW.copy_from(vw); }
+        void setvb(ConstMatrixView vbias) { vb.copy_from(vbias); }
+
+        // Data-parallel replicas: W and b become views of source's
+        void share_parameters(Layer& source);
 
         void forward();
         void backprop();
 
-        void step(double lr, double beta);
-
     private:
         void backprop_relu();
         void backprop_softmax();
+        void backprop_weights();
 };
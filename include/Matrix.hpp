@@ -1,44 +1,110 @@
 // matrix.hpp
 
 #pragma once
+#include "Arena.hpp"
+#include "Gemm.hpp"
+#include "MatrixView.hpp"
+#include "Precision.hpp"
 #include <iostream>
 #include <vector>
 
+template <class E> struct MatrixExpr;
+
+namespace expr
+{
+    class Ref;
+    struct Mul;
+    template <class L, class R, class Op> class Binary;
+    class Transposed;
+    class Product;
+    template <class E> class ProductPlus;
+}
+
 class Matrix 
 {
     private:
         size_t row, col;
-        std::vector<double> data;
+
+        // Owned storage; empty for a view. values points at whichever
+        // memory the matrix uses.
+        std::vector<Scalar, AlignedAllocator<Scalar>> storage;
+        Scalar* values;
 
     public:
         Matrix();
         Matrix(size_t row, size_t col);
-        Matrix(size_t row, size_t col, std::vector<double> data);
+        Matrix(size_t row, size_t col, std::vector<Scalar> data);
+
+        // Copies always own their storage. A view keeps its memory when
+        // moved, and assigning to a view writes through it, so it can
+        // never change shape.
+        Matrix(const Matrix& other);
+        Matrix(Matrix&& other) noexcept;
+        // Owning copy of a view's elements
+        explicit Matrix(ConstMatrixView v);
 
-        double get(size_t row, size_t col) const;
-        void set(size_t row, size_t col, double value);
+        // A rows x cols matrix over memory owned by someone else (usually
+        // an Arena), which must outlive it.
+        static Matrix view(Scalar* memory, size_t rows, size_t cols);
 
-        void fill(double value);
+        // Evaluate a lazy expression (see MatrixExpr.hpp)
+        template <class E> Matrix(const MatrixExpr<E>& e);
+        Matrix(const expr::Transposed& t);
+        Matrix(const expr::Product& p);
+        template <class E> Matrix(const expr::ProductPlus<E>& p);
+
+        Scalar get(size_t row, size_t col) const;
+        void set(size_t row, size_t col, Scalar value);
+
+        void fill(Scalar value);
 
         size_t rows() const;
         size_t cols() const;
         
-        const std::vector<double>& get_data() const { return data; }
-        void set_data(const std::vector<double>& new_data) { data = new_data; }
+        Scalar* data() { return values; }
+        const Scalar* data() const { return values; }
+        void set_data(const std::vector<Scalar>& new_data);
+        // Copies a view of the same shape into this matrix's memory
+        void copy_from(ConstMatrixView v);
+
+        operator MatrixView() { return MatrixView(values, row, col); }
+        operator ConstMatrixView() const { return ConstMatrixView(values, row, col); }
+
+        bool is_view() const { return values != storage.data(); }
+
+        // Moves the contents into memory (rows * cols Scalars) and turns
+        // this matrix into a view of it.
+        void rebind(Scalar* memory);
+        // Turns this matrix into a rows x cols view of memory as it is;
+        // the current contents are dropped.
+        void rebind(Scalar* memory, size_t rows, size_t cols);
 
         Matrix& operator+=(const Matrix& other);
         Matrix& operator-=(const Matrix& other);
-        Matrix& operator*=(double scalar);
+        Matrix& operator*=(Scalar scalar);
         Matrix& operator*=(const Matrix& other);
         Matrix& operator=(const Matrix& other);
+        Matrix& operator=(Matrix&& other);
 
-        Matrix operator+(const Matrix& other) const;
-        Matrix operator-(const Matrix& other) const;
-        Matrix operator*(double scalar) const;
-        Matrix operator*(const Matrix& other) const;
+        template <class E> Matrix& operator=(const MatrixExpr<E>& e);
+        template <class E> Matrix& operator+=(const MatrixExpr<E>& e);
+        template <class E> Matrix& operator-=(const MatrixExpr<E>& e);
 
-        Matrix hadamard(const Matrix& other) const;
-        Matrix transpose() const;
+        Matrix& operator=(const expr::Transposed& t);
+        Matrix& operator=(const expr::Product& p);
+        Matrix& operator+=(const expr::Product& p);
+        Matrix& operator-=(const expr::Product& p);
+        template <class E> Matrix& operator=(const expr::ProductPlus<E>& p);
+
+        // this += alpha * other
+        Matrix& add_scaled(const Matrix& other, Scalar alpha);
+
+        // Unblocked triple-loop product, for validating the GEMM engine
+        Matrix multiply_reference(const Matrix& other) const;
+
+        expr::Binary<expr::Ref, expr::Ref, expr::Mul> hadamard(const Matrix& other) const;
+        // Lazy: multiplying by it reads this matrix transposed in place
+        expr::Transposed transpose() const;
 
 
         // Activation functions
@@ -47,5 +113,45 @@ class Matrix
 
         Matrix softmax() const;
 
+        // Output-parameter variants over views (a Matrix converts to one):
+        // dst must already have the result's dimensions and is written
+        // without allocating. Element-wise ones may alias their inputs;
+        // products and transposes may not. The trans_a / trans_b form
+        // multiplies op(a) * op(b) without forming a transposed copy of
+        // either operand.
+        static void add_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b);
+        static void sub_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b);
+        static void scale_into(MatrixView dst, ConstMatrixView a, Scalar scalar);
+        static void hadamard_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b);
+        static void multiply_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b,
+                                  Scalar alpha = 1.0, Scalar beta = 0.0);
+        static void multiply_into(MatrixView dst, ConstMatrixView a, gemm::Trans trans_a,
+                                  ConstMatrixView b, gemm::Trans trans_b,
+                                  Scalar alpha = 1.0, Scalar beta = 0.0);
+        static void transpose_into(MatrixView dst, ConstMatrixView a);
+        // Every column of dst = column (rows x 1)
+        static void broadcast_into(MatrixView dst, ConstMatrixView column);
+        // dst (rows x 1) = alpha * sum of a's columns
+        static void sum_cols_into(MatrixView dst, ConstMatrixView a, Scalar alpha = 1.0);
+
+        // dst = a * b + bias, bias (rows x 1) added to every column inside
+        // the product's final store; activated, when given, receives
+        // relu(dst) or a copy of dst in the same pass
+        static void affine_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b, ConstMatrixView bias,
+                                MatrixView activated = MatrixView(),
+                                gemm::Activation activation = gemm::Activation::Linear);
+
+        static void relu_into(MatrixView dst, ConstMatrixView a);
+        static void drelu_into(MatrixView dst, ConstMatrixView a);
+        // dst = grad (.) drelu(a) in one pass
+        static void relu_backward_into(MatrixView dst, ConstMatrixView grad, ConstMatrixView a);
+        static void softmax_into(MatrixView dst, ConstMatrixView a);
+
         void print() const;
+
+    private:
+        void reshape(size_t rows, size_t cols);
 };
+
+#include "MatrixExpr.hpp"
+
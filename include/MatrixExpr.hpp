@@ -0,0 +1,417 @@
+// matrixexpr.hpp
+//
+// Lazy Matrix arithmetic. +, -, hadamard and scalar * build expression
+// nodes instead of matrices; assigning a node to a Matrix evaluates the
+// whole tree in a single fused loop. A matrix product is a node too:
+// assigned on its own it runs the GEMM straight into the destination, and
+// "A * B + E" seeds the destination with E and lets the GEMM accumulate
+// on top of it. transpose() is lazy as well, so "W.transpose() * dZ"
+// becomes a GEMM with a transpose flag instead of a copy.
+//
+// The common leaf shapes (A + B, A - B, hadamard, A * s, A * s + B * t,
+// and += / -= of A * s) go to the active SIMD kernel table, which runs at
+// the CPU's full vector width. Deeper trees take the fused loop, which is
+// compiled with the baseline flags.
+//
+// Nodes are held by value but only point at the data of their leaf
+// matrices, so a node must not outlive the matrices it was built from.
+
+#pragma once
+#include "Kernels.hpp"
+#include "Matrix.hpp"
+#include <stdexcept>
+#include <type_traits>
+
+// Element-wise loops only ever read index i before writing index i, so
+// they are safe to vectorize even when the destination is an operand.
+#if defined(__clang__)
+#define CRNN_ELEMENTWISE_LOOP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define CRNN_ELEMENTWISE_LOOP _Pragma("GCC ivdep")
+#else
+#define CRNN_ELEMENTWISE_LOOP
+#endif
+
+template <class E>
+struct MatrixExpr
+{
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+namespace expr
+{
+    using BinaryKernel = void (*kernels::KernelTable::*)(const Scalar*, const Scalar*, Scalar*, size_t);
+
+    struct Add
+    {
+        static Scalar apply(Scalar a, Scalar b) { return a + b; }
+        static constexpr BinaryKernel kernel = &kernels::KernelTable::add;
+        static constexpr Scalar sign = 1;
+    };
+
+    struct Sub
+    {
+        static Scalar apply(Scalar a, Scalar b) { return a - b; }
+        static constexpr BinaryKernel kernel = &kernels::KernelTable::sub;
+        static constexpr Scalar sign = -1;
+    };
+
+    struct Mul
+    {
+        static Scalar apply(Scalar a, Scalar b) { return a * b; }
+        static constexpr BinaryKernel kernel = &kernels::KernelTable::mul;
+    };
+
+    // Leaf: a Matrix's storage
+    class Ref : public MatrixExpr<Ref>
+    {
+        private:
+            const Scalar* values;
+            size_t r, c;
+
+        public:
+            explicit Ref(const Matrix& m) : values(m.data()), r(m.rows()), c(m.cols()) {}
+
+            size_t rows() const { return r; }
+            size_t cols() const { return c; }
+            Scalar at(size_t i) const { return values[i]; }
+            const Scalar* data() const { return values; }
+    };
+
+    template <class L, class R, class Op>
+    class Binary : public MatrixExpr<Binary<L, R, Op>>
+    {
+        private:
+            L lhs;
+            R rhs;
+
+        public:
+            Binary(const L& lhs, const R& rhs, const char* mismatch) : lhs(lhs), rhs(rhs)
+            {
+                if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+                {
+                    throw std::invalid_argument(mismatch);
+                }
+            }
+
+            size_t rows() const { return lhs.rows(); }
+            size_t cols() const { return lhs.cols(); }
+            Scalar at(size_t i) const { return Op::apply(lhs.at(i), rhs.at(i)); }
+            const L& left() const { return lhs; }
+            const R& right() const { return rhs; }
+    };
+
+    template <class E>
+    class Scaled : public MatrixExpr<Scaled<E>>
+    {
+        private:
+            E operand;
+            Scalar scalar;
+
+        public:
+            Scaled(const E& operand, Scalar scalar) : operand(operand), scalar(scalar) {}
+
+            size_t rows() const { return operand.rows(); }
+            size_t cols() const { return operand.cols(); }
+            Scalar at(size_t i) const { return operand.at(i) * scalar; }
+            const E& base() const { return operand; }
+            Scalar factor() const { return scalar; }
+    };
+
+    class Transposed
+    {
+        public:
+            const Matrix& m;
+
+            explicit Transposed(const Matrix& m) : m(m) {}
+
+            size_t rows() const { return m.cols(); }
+            size_t cols() const { return m.rows(); }
+    };
+
+    // op(a) * op(b)
+    class Product
+    {
+        public:
+            const Matrix& a;
+            gemm::Trans trans_a;
+            const Matrix& b;
+            gemm::Trans trans_b;
+
+            Product(const Matrix& a, gemm::Trans trans_a, const Matrix& b, gemm::Trans trans_b)
+                : a(a), trans_a(trans_a), b(b), trans_b(trans_b)
+            {
+                const size_t inner_a = trans_a == gemm::Trans::No ? a.cols() : a.rows();
+                const size_t inner_b = trans_b == gemm::Trans::No ? b.rows() : b.cols();
+                if (inner_a != inner_b)
+                {
+                    throw std::invalid_argument("Matrix dimensions incompatible for multiplication");
+                }
+            }
+
+            size_t rows() const { return trans_a == gemm::Trans::No ? a.rows() : a.cols(); }
+            size_t cols() const { return trans_b == gemm::Trans::No ? b.cols() : b.rows(); }
+
+            // dst = alpha * op(a) * op(b) + beta * dst
+            void evaluate_into(Matrix& dst, Scalar alpha, Scalar beta) const
+            {
+                Matrix::multiply_into(dst, a, trans_a, b, trans_b, alpha, beta);
+            }
+
+            bool aliases(const Matrix& m) const { return &m == &a || &m == &b; }
+    };
+
+    // A * B + addend, evaluated as a GEMM with beta = 1 over the addend
+    template <class E>
+    class ProductPlus
+    {
+        public:
+            Product product;
+            E addend;
+
+            ProductPlus(const Product& product, const E& addend) : product(product), addend(addend)
+            {
+                if (product.rows() != addend.rows() || product.cols() != addend.cols())
+                {
+                    throw std::invalid_argument("Matrix dimensions must match for addition");
+                }
+            }
+
+            size_t rows() const { return product.rows(); }
+            size_t cols() const { return product.cols(); }
+    };
+
+    // out = x through the kernel table, for the shapes it covers; false
+    // leaves the expression to the fused loop. out may be any of the leaves.
+    template <class E>
+    bool assign_kernel(Scalar*, const E&, size_t) { return false; }
+
+    template <class Op>
+    bool assign_kernel(Scalar* out, const Binary<Ref, Ref, Op>& x, size_t n)
+    {
+        (kernels::active().*Op::kernel)(x.left().data(), x.right().data(), out, n);
+        return true;
+    }
+
+    inline bool assign_kernel(Scalar* out, const Scaled<Ref>& x, size_t n)
+    {
+        kernels::active().scale(x.base().data(), x.factor(), out, n);
+        return true;
+    }
+
+    // a * s +/- b * t as a scale then an axpy, started from whichever
+    // operand out does not overwrite
+    template <class Op, typename std::enable_if<Op::sign != 0, int>::type = 0>
+    bool assign_kernel(Scalar* out, const Binary<Scaled<Ref>, Scaled<Ref>, Op>& x, size_t n)
+    {
+        const kernels::KernelTable& k = kernels::active();
+        const Scaled<Ref>& a = x.left();
+        const Scaled<Ref>& b = x.right();
+
+        if (out != b.base().data())
+        {
+            k.scale(a.base().data(), a.factor(), out, n);
+            k.axpy(Op::sign * b.factor(), b.base().data(), out, n);
+        }
+        else if (out != a.base().data())
+        {
+            k.scale(b.base().data(), Op::sign * b.factor(), out, n);
+            k.axpy(a.factor(), a.base().data(), out, n);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // out += sign * x
+    template <class E>
+    bool accumulate_kernel(Scalar*, const E&, Scalar, size_t) { return false; }
+
+    inline bool accumulate_kernel(Scalar* out, const Scaled<Ref>& x, Scalar sign, size_t n)
+    {
+        kernels::active().axpy(sign * x.factor(), x.base().data(), out, n);
+        return true;
+    }
+
+    template <class T>
+    struct is_operand : std::integral_constant<bool,
+        std::is_same<T, Matrix>::value || std::is_base_of<MatrixExpr<T>, T>::value> {};
+
+    template <class T>
+    using operand_t = typename std::conditional<std::is_same<T, Matrix>::value, Ref, T>::type;
+
+    inline Ref operand(const Matrix& m) { return Ref(m); }
+
+    template <class E>
+    const E& operand(const MatrixExpr<E>& e) { return e.self(); }
+}
+
+// Operators
+
+template <class L, class R, typename std::enable_if<expr::is_operand<L>::value && expr::is_operand<R>::value, int>::type = 0>
+expr::Binary<expr::operand_t<L>, expr::operand_t<R>, expr::Add> operator+(const L& lhs, const R& rhs)
+{
+    return { expr::operand(lhs), expr::operand(rhs), "Matrix dimensions must match for addition" };
+}
+
+template <class L, class R, typename std::enable_if<expr::is_operand<L>::value && expr::is_operand<R>::value, int>::type = 0>
+expr::Binary<expr::operand_t<L>, expr::operand_t<R>, expr::Sub> operator-(const L& lhs, const R& rhs)
+{
+    return { expr::operand(lhs), expr::operand(rhs), "Matrix dimensions must match for subtraction" };
+}
+
+template <class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::Scaled<expr::operand_t<T>> operator*(const T& e, Scalar scalar)
+{
+    return { expr::operand(e), scalar };
+}
+
+template <class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::Scaled<expr::operand_t<T>> operator*(Scalar scalar, const T& e)
+{
+    return { expr::operand(e), scalar };
+}
+
+inline expr::Product operator*(const Matrix& a, const Matrix& b)
+{
+    return expr::Product(a, gemm::Trans::No, b, gemm::Trans::No);
+}
+
+inline expr::Product operator*(const expr::Transposed& a, const Matrix& b)
+{
+    return expr::Product(a.m, gemm::Trans::Yes, b, gemm::Trans::No);
+}
+
+inline expr::Product operator*(const Matrix& a, const expr::Transposed& b)
+{
+    return expr::Product(a, gemm::Trans::No, b.m, gemm::Trans::Yes);
+}
+
+inline expr::Product operator*(const expr::Transposed& a, const expr::Transposed& b)
+{
+    return expr::Product(a.m, gemm::Trans::Yes, b.m, gemm::Trans::Yes);
+}
+
+template <class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::ProductPlus<expr::operand_t<T>> operator+(const expr::Product& p, const T& e)
+{
+    return { p, expr::operand(e) };
+}
+
+template <class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::ProductPlus<expr::operand_t<T>> operator+(const T& e, const expr::Product& p)
+{
+    return { p, expr::operand(e) };
+}
+
+template <class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::ProductPlus<expr::Scaled<expr::operand_t<T>>> operator-(const expr::Product& p, const T& e)
+{
+    return { p, expr::Scaled<expr::operand_t<T>>(expr::operand(e), -1.0) };
+}
+
+template <class E, class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::ProductPlus<expr::Binary<E, expr::operand_t<T>, expr::Add>> operator+(const expr::ProductPlus<E>& p, const T& e)
+{
+    return { p.product, p.addend + e };
+}
+
+template <class E, class T, typename std::enable_if<expr::is_operand<T>::value, int>::type = 0>
+expr::ProductPlus<expr::Binary<E, expr::operand_t<T>, expr::Sub>> operator-(const expr::ProductPlus<E>& p, const T& e)
+{
+    return { p.product, p.addend - e };
+}
+
+// Matrix members that evaluate expressions
+
+inline expr::Transposed Matrix::transpose() const
+{
+    return expr::Transposed(*this);
+}
+
+inline expr::Binary<expr::Ref, expr::Ref, expr::Mul> Matrix::hadamard(const Matrix& other) const
+{
+    return { expr::Ref(*this), expr::Ref(other), "Matrix dimensions must match for hadamard product" };
+}
+
+template <class E>
+Matrix::Matrix(const MatrixExpr<E>& e) : row(0), col(0), values(nullptr)
+{
+    *this = e;
+}
+
+template <class E>
+Matrix::Matrix(const expr::ProductPlus<E>& p) : row(0), col(0), values(nullptr)
+{
+    *this = p;
+}
+
+template <class E>
+Matrix& Matrix::operator=(const MatrixExpr<E>& e)
+{
+    const E x = e.self();
+    reshape(x.rows(), x.cols());
+
+    Scalar* out = values;
+    const size_t n = row * col;
+    if (expr::assign_kernel(out, x, n)) return *this;
+
+    CRNN_ELEMENTWISE_LOOP
+    for (size_t i = 0; i < n; i++) out[i] = x.at(i);
+
+    return *this;
+}
+
+template <class E>
+Matrix& Matrix::operator+=(const MatrixExpr<E>& e)
+{
+    const E x = e.self();
+    if (x.rows() != row || x.cols() != col)
+    {
+        throw std::invalid_argument("Matrix dimensions must match for addition");
+    }
+
+    Scalar* out = values;
+    const size_t n = row * col;
+    if (expr::accumulate_kernel(out, x, 1.0, n)) return *this;
+
+    CRNN_ELEMENTWISE_LOOP
+    for (size_t i = 0; i < n; i++) out[i] += x.at(i);
+
+    return *this;
+}
+
+template <class E>
+Matrix& Matrix::operator-=(const MatrixExpr<E>& e)
+{
+    const E x = e.self();
+    if (x.rows() != row || x.cols() != col)
+    {
+        throw std::invalid_argument("Matrix dimensions must match for subtraction");
+    }
+
+    Scalar* out = values;
+    const size_t n = row * col;
+    if (expr::accumulate_kernel(out, x, -1.0, n)) return *this;
+
+    CRNN_ELEMENTWISE_LOOP
+    for (size_t i = 0; i < n; i++) out[i] -= x.at(i);
+
+    return *this;
+}
+
+template <class E>
+Matrix& Matrix::operator=(const expr::ProductPlus<E>& p)
+{
+    if (p.product.aliases(*this))
+    {
+        Matrix result(p);
+        return *this = result;
+    }
+
+    *this = p.addend;
+    p.product.evaluate_into(*this, 1.0, 1.0);
+    return *this;
+}
@@ -0,0 +1,72 @@
+// matrixview.hpp
+
+#pragma once
+#include "Precision.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Non-owning window onto row-major Scalars: rows x cols elements, with
+// consecutive rows stride elements apart (stride >= cols). A Matrix
+// converts to a view of itself, and every Matrix kernel takes views, so
+// dataset rows, sub-blocks and externally owned buffers (arenas, mapped
+// files) can be used in place. A view must not outlive its memory.
+template <class T>
+class BasicMatrixView
+{
+    private:
+        T* ptr;
+        size_t r, c, ld;
+
+    public:
+        BasicMatrixView() : ptr(nullptr), r(0), c(0), ld(0) {}
+        BasicMatrixView(T* data, size_t rows, size_t cols) : ptr(data), r(rows), c(cols), ld(cols) {}
+        BasicMatrixView(T* data, size_t rows, size_t cols, size_t stride)
+            : ptr(data), r(rows), c(cols), ld(stride)
+        {
+            if (stride < cols && rows > 1)
+            {
+                throw std::invalid_argument(
+                    "View stride " + std::to_string(stride) + " is smaller than its " + std::to_string(cols) + " columns"
+                );
+            }
+        }
+
+        // MatrixView -> ConstMatrixView
+        template <class U, class = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+        BasicMatrixView(const BasicMatrixView<U>& other)
+            : ptr(other.data()), r(other.rows()), c(other.cols()), ld(other.stride()) {}
+
+        T* data() const { return ptr; }
+        size_t rows() const { return r; }
+        size_t cols() const { return c; }
+        size_t stride() const { return ld; }
+        size_t size() const { return r * c; }
+
+        // Rows follow each other with no gap, so the view is one flat run
+        bool is_contiguous() const { return ld == c || r <= 1; }
+
+        T* row_data(size_t i) const { return ptr + i * ld; }
+
+        Scalar get(size_t i, size_t j) const { return ptr[i * ld + j]; }
+        void set(size_t i, size_t j, Scalar value) const { ptr[i * ld + j] = value; }
+
+        BasicMatrixView row(size_t i) const { return block(i, 0, 1, c); }
+
+        BasicMatrixView block(size_t row0, size_t col0, size_t rows, size_t cols) const
+        {
+            if (row0 + rows > r || col0 + cols > c)
+            {
+                throw std::out_of_range(
+                    "Block " + std::to_string(rows) + "x" + std::to_string(cols) + " at (" +
+                    std::to_string(row0) + ", " + std::to_string(col0) + ") exceeds " +
+                    std::to_string(r) + "x" + std::to_string(c) + " view"
+                );
+            }
+            return BasicMatrixView(ptr + row0 * ld + col0, rows, cols, ld);
+        }
+};
+
+using MatrixView = BasicMatrixView<Scalar>;
+using ConstMatrixView = BasicMatrixView<const Scalar>;
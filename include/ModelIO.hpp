@@ -2,20 +2,96 @@
 #include "Network.hpp"
 #include "Layer.hpp"
 #include "Matrix.hpp"
+#include "Optimizer.hpp"
+#include "Precision.hpp"
 #include <string>
 #include <fstream>
 #include <vector>
 
 class Network;
+class InferenceModel;
+class QuantizedModel;
 
+// Checkpoints start with a "CRNN" magic, a format version and the element
+// precision of every value that follows. Version 3 lists each layer's
+// shape and activation and the optimizer (type, hyperparameters, steps
+// taken), then writes the network's ParameterStore as two flat blocks:
+// all parameters, then all optimizer state. Version 2 has no optimizer
+// record (its state is SGD momentum); version 1 and files without the
+// magic (the original headerless float64 format) store W, b, vW and vb as
+// matrices per layer. Both are still accepted. Values are converted to
+// the build's Scalar type on load. Optimizer state is restored only when
+// the network uses the same optimizer type as the file; otherwise it
+// starts from zero. load_inference() reads the shapes and parameters
+// alone, seeking past optimizer state and momentum instead of reading it.
+//
+// Quantized checkpoints carry precision Int8 after the usual header, then
+// the layer shapes, the float32 input scales and, per layer, its int8
+// weights (output x input) and float32 epilogue scales and biases, each
+// as a counted block.
 class ModelIO {
 public:
+    static constexpr char MAGIC[4] = { 'C', 'R', 'N', 'N' };
+    static constexpr uint32_t VERSION = 3;
+
+    struct LayerShape
+    {
+        size_t input_size;
+        size_t output_size;
+        Activation activation;
+    };
+
+    // Everything a checkpoint holds, copied out of a Network so it can be
+    // written later (see CheckpointWriter) while training carries on.
+    // Capturing into the same Snapshot again reuses its buffers.
+    struct Snapshot
+    {
+        std::vector<LayerShape> layers;
+        Optimizer optimizer = Optimizer::sgd_momentum();
+        std::vector<Scalar> parameters;
+        std::vector<Scalar> state;
+
+        Loss loss_type = Loss::CROSS_ENTROPY;
+        double learning_rate = 0.0;
+        double best_accuracy = 0.0;
+        size_t patience = 0;
+        double factor = 0.0;
+        double min_lr = 0.0;
+        double min_delta = 0.0;
+    };
+
     static void save_model(const Network& network, const std::string& filepath);
     static void load_model(Network& network, const std::string& filepath);
+    static InferenceModel load_inference(const std::string& filepath);
+
+    static void save_quantized(const QuantizedModel& model, const std::string& filepath);
+    static QuantizedModel load_quantized(const std::string& filepath);
+
+    static void capture(const Network& network, Snapshot& snapshot);
+    // Writes to filepath + ".tmp", fsyncs it and renames it over filepath,
+    // so filepath always holds either the old or the new checkpoint whole.
+    // Missing directories are created.
+    static void write_snapshot(const Snapshot& snapshot, const std::string& filepath);
+    static void create_directories(const std::string& dir);
     
+    static void write_header(std::ofstream& file, Precision precision = SCALAR_PRECISION);
+    // Headerless files report version 1
+    static Precision read_header(std::ifstream& file, uint32_t& version);
+
+    static void write_block(std::ofstream& file, const Scalar* data, size_t count);
+    static void read_block(std::ifstream& file, Precision precision, Scalar* data, size_t count);
+    static void skip_block(std::ifstream& file, Precision precision);
+
+    static void write_optimizer(std::ofstream& file, const Optimizer& optimizer);
+    // The stored optimizer: its type, hyperparameters and step count
+    static Optimizer read_optimizer(std::ifstream& file);
+
     static void write_matrix(std::ofstream& file, const Matrix& matrix);
-    static Matrix read_matrix(std::ifstream& file);
+    static Matrix read_matrix(std::ifstream& file, Precision precision);
+    // Reads a stored rows x cols matrix straight into data
+    static void read_matrix_into(std::ifstream& file, Precision precision, Scalar* data, size_t rows, size_t cols);
+    static void skip_matrix(std::ifstream& file, Precision precision);
     static void write_layer(std::ofstream& file, const Layer& layer);
-    static Layer read_layer(std::ifstream& file);
+    static Layer read_layer(std::ifstream& file, Precision precision);
 };
 
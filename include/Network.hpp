@@ -1,21 +1,75 @@
 // network.hpp
 
 #pragma once
+#include "Arena.hpp"
 #include "Functions.hpp"
 #include "Layer.hpp"
 #include "Matrix.hpp"
 #include "Dataset.hpp"
+#include "DataLoader.hpp"
+#include "Optimizer.hpp"
+#include "ParameterStore.hpp"
 #include <vector>
 #include <tuple>
 #include <memory>
 #include <string>
 
+class CheckpointWriter;
+class Pipeline;
+
 class Network 
 {
     private:
         std::vector<Layer> layers;
         Loss loss_type;
 
+        // Every W and b, their gradients and optimizer state, layer after layer
+        ParameterStore parameters;
+        Optimizer optimizer = Optimizer::sgd_momentum();
+        double max_grad_norm = 0.0;
+
+        // Backing memory for the activation buffers, sized at construction
+        // and re-planned only when a wider batch than batch_capacity is needed
+        Arena arena;
+        size_t batch_capacity = 0;
+
+        void plan_parameters();
+        void plan_workspace(size_t capacity);
+        void set_batch(size_t batch);
+
+        // Data-parallel training: each replica has its own activations and
+        // gradients but reads this network's W and b
+        size_t num_threads = 1;
+        TrainStrategy strategy = TrainStrategy::SYNCHRONOUS;
+        std::vector<std::unique_ptr<Network>> replicas;
+
+        Network(Network& master, size_t capacity);
+        void build_replicas(size_t workers, size_t capacity);
+        Network& worker(size_t r) { return r == 0 ? *this : *replicas[r - 1]; }
+        void merge_replica_metrics();
+
+        // Layer pipelining: stage s runs layers stage_layers[s] up to
+        // stage_layers[s + 1] and reduces their gradients, parameters
+        // stage_params[s] up to stage_params[s + 1]. Each micro-batch uses
+        // its own replica's activations and gradients.
+        std::unique_ptr<Pipeline> pipeline;
+        std::vector<size_t> stage_layers;
+        std::vector<size_t> stage_params;
+        size_t micro_batches = 0;
+        void build_pipeline(size_t stages, size_t parts);
+
+        // Runs samples [0, samples) through the network in chunks, one
+        // InferenceSession per thread: gather(first, input) fills a
+        // features x count chunk, store(output, first) takes its output
+        template <class Gather, class Store>
+        void predict_chunks(size_t samples, Gather&& gather, Store&& store) const;
+
+        void train_epoch_synchronous(DataLoader& loader);
+        void train_epoch_hogwild(DataLoader& loader);
+        void train_batch(ConstMatrixView input, const size_t* labels);
+        void train_batch_pipelined(ConstMatrixView input, const size_t* labels);
+        void run_training(DataLoader& loader, const Dataset* validation, size_t epochs);
+
         double learning_rate;
         double accumulated_loss = 0.0;
         double accuracy = 0.0;
@@ -28,35 +82,110 @@ class Network
         double min_lr = 1e-6;
         double min_delta = 0.001;
 
+        // Early stopping: evaluations in a row without a new best
+        size_t early_stopping = 0;
+        size_t stale_evaluations = 0;
+
+        bool track_plateau(double score);
+        // True once early stopping should end training
+        bool track_early_stopping(bool improved);
+
+        // Background writer for plateau checkpoints, started on first use
+        std::unique_ptr<CheckpointWriter> checkpoints;
+
         size_t correct_predictions = 0;
         size_t dataset_size = 0;
 
     public:
         Network(std::vector<Layer> layers, double learning_rate, InitType init_type, Loss loss_type = Loss::CROSS_ENTROPY);
+        // Waits for any checkpoint still being written
+        ~Network();
 
         void init_weights(InitType init_type);
         void load(const std::string& filepath);
         void save(const std::string& filepath);
         const Matrix& get_output() const;
 
-        void train(Dataset& dataset, size_t epochs);
-        void forward(const Matrix& input);
+        // Mini-batch training: gradients are averaged over batch_size
+        // samples and the optimizer steps once per batch
+        void train(Dataset& dataset, size_t epochs, size_t batch_size = 1);
+        // The same, taking batches (and their shuffling and normalization)
+        // from a loader the caller configured; one pass over it per epoch
+        void train(DataLoader& loader, size_t epochs);
+        // Plateau detection, early stopping and checkpoint selection follow
+        // accuracy on validation instead of training accuracy. Validation
+        // runs on its own thread against a copy of the weights taken after
+        // each epoch, so training never waits for it.
+        void train(Dataset& dataset, const Dataset& validation, size_t epochs, size_t batch_size = 1);
+        void train(DataLoader& loader, const Dataset& validation, size_t epochs);
+        // Accuracy over dataset, run batch_size samples at a time; the mean
+        // loss goes to loss. Training metrics are left untouched.
+        double evaluate(const Dataset& dataset, size_t batch_size, double& loss);
+
+        // Samples per chunk in predict_batch()
+        static constexpr size_t PREDICT_CHUNK = 256;
+
+        // Bulk inference over inputs of samples x features (one sample per
+        // row), or over a Dataset in its index order. Chunks of
+        // PREDICT_CHUNK samples go through the network as one product per
+        // layer, spread over get_num_threads() threads. Labels are the most
+        // probable class; probabilities are samples x classes.
+        std::vector<size_t> predict_batch(ConstMatrixView inputs) const;
+        std::vector<size_t> predict_batch(const Dataset& dataset) const;
+        Matrix predict_proba_batch(ConstMatrixView inputs) const;
+        Matrix predict_proba_batch(const Dataset& dataset) const;
+        // Threads (network replicas) sharing each mini-batch in train() and
+        // the chunks of predict_batch();
+        // each gets a slice of the batch, so batch_size should be at least
+        // this. Grows ThreadPool::global() to match.
+        void set_num_threads(size_t threads);
+        size_t get_num_threads() const { return num_threads; }
+        void set_strategy(TrainStrategy s) { strategy = s; }
+        TrainStrategy get_strategy() const { return strategy; }
+        // Pieces each mini-batch is cut into under TrainStrategy::PIPELINE,
+        // where the layers are split over min(threads, layers) stages; 0
+        // (the default) uses four per stage
+        void set_micro_batches(size_t n) { micro_batches = n; }
+        size_t get_micro_batches() const { return micro_batches; }
+        // Room for batches of up to capacity samples, so forward() on them
+        // does not re-plan the workspace
+        void reserve_batch(size_t capacity);
+
+        // input is features x batch, one sample per column
+        void forward(ConstMatrixView input);
         void backprop(size_t label);
+        // One label per column of the last forward() input
+        void backprop(const size_t* labels);
         void step(double learning_rate);
+        // Replaces the update rule, clearing any optimizer state
+        void set_optimizer(const Optimizer& o);
+        const Optimizer& get_optimizer() const { return optimizer; }
+        Optimizer& get_optimizer() { return optimizer; }
+        // Gradients longer than this (L2 over all parameters) are scaled
+        // down to it before each step; 0 disables clipping
+        void set_max_grad_norm(double norm) { max_grad_norm = norm; }
+        double get_max_grad_norm() const { return max_grad_norm; }
 
-        void lr_reduce_on_plateau();
+        // Tracks training accuracy and checkpoints on a new best; returns
+        // whether there was one
+        bool lr_reduce_on_plateau();
 
         void loss_gradient(size_t label);
-        void accumulate_loss(const Matrix& prediction, size_t label);
+        void loss_gradient(const size_t* labels);
+        void accumulate_loss(ConstMatrixView prediction, size_t label);
+        void accumulate_loss(ConstMatrixView prediction, const size_t* labels);
 
-        void compute_accuracy(const Matrix& prediction, size_t label);
+        void compute_accuracy(ConstMatrixView prediction, size_t label);
+        void compute_accuracy(ConstMatrixView prediction, const size_t* labels);
         void reset_epoch_metrics();
         void print_accuracy();
 
-        size_t argmax(const Matrix& prediction);
+        size_t argmax(ConstMatrixView prediction, size_t column = 0) const;
         
         // Model I/O getters
         std::vector<Layer>& get_layers() { return layers; }
+        ParameterStore& get_parameters() { return parameters; }
+        const ParameterStore& get_parameters() const { return parameters; }
         const std::vector<Layer>& get_layers() const { return layers; }
         Loss get_loss_type() const { return loss_type; }
         double get_learning_rate() const { return learning_rate; }
@@ -65,6 +194,7 @@ class Network
         double get_factor() const { return factor; }
         double get_min_lr() const { return min_lr; }
         double get_min_delta() const { return min_delta; }
+        size_t get_early_stopping() const { return early_stopping; }
         
         // Model I/O setters
         void set_learning_rate(double lr) { learning_rate = lr; }
@@ -73,4 +203,7 @@ class Network
         void set_factor(double f) { factor = f; }
         void set_min_lr(double mlr) { min_lr = mlr; }
         void set_min_delta(double md) { min_delta = md; }
+        // Stop training after this many evaluations without improvement;
+        // 0 (the default) never stops early
+        void set_early_stopping(size_t evaluations) { early_stopping = evaluations; }
 };
@@ -0,0 +1,52 @@
+// optimizer.hpp
+
+#pragma once
+#include "Functions.hpp"
+#include "ParameterStore.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Update rule Network::step applies to its whole ParameterStore, as one
+// fused SIMD pass over the parameter, gradient and state buffers. Build
+// one with a named constructor and hand it to Network::set_optimizer:
+//
+//     sgd_momentum   v = beta v + (1 - beta) g;  p -= lr v   (the default)
+//     nesterov       as above, stepping by beta v + (1 - beta) g
+//     adam           bias-corrected first / second moment estimates
+//     adamw          adam with weight decay decoupled from the gradient
+//     rmsprop        p -= lr g / (sqrt(v) + epsilon), v averaging g^2
+class Optimizer
+{
+    private:
+        OptimizerType type;
+        double beta1;           // momentum / first moment decay
+        double beta2;           // second moment decay (rho for RMSProp)
+        double epsilon;
+        double weight_decay;
+        uint64_t steps = 0;
+
+        Optimizer(OptimizerType type, double beta1, double beta2, double epsilon, double weight_decay);
+
+    public:
+        static Optimizer sgd_momentum(double beta = 0.9);
+        static Optimizer nesterov(double beta = 0.9);
+        static Optimizer adam(double beta1 = 0.9, double beta2 = 0.999, double epsilon = 1e-8);
+        static Optimizer adamw(double weight_decay = 0.01, double beta1 = 0.9, double beta2 = 0.999,
+                               double epsilon = 1e-8);
+        static Optimizer rmsprop(double rho = 0.99, double epsilon = 1e-8);
+
+        OptimizerType get_type() const { return type; }
+        double get_beta1() const { return beta1; }
+        double get_beta2() const { return beta2; }
+        double get_epsilon() const { return epsilon; }
+        double get_weight_decay() const { return weight_decay; }
+
+        // Steps taken so far; Adam's bias correction depends on it
+        uint64_t get_steps() const { return steps; }
+        void set_steps(uint64_t s) { steps = s; }
+
+        // ParameterStore state slots the rule keeps per parameter
+        size_t state_slots() const;
+
+        void step(ParameterStore& store, double learning_rate);
+};
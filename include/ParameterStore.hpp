@@ -0,0 +1,56 @@
+// parameterstore.hpp
+
+#pragma once
+#include "Arena.hpp"
+#include "Precision.hpp"
+#include <cstddef>
+
+// Every trainable parameter of a network in one contiguous buffer, with a
+// gradient buffer and optimizer-state slots laid out identically. Each
+// layer's W and b (and dW, db, vW, vb) are views at the same offset in
+// each buffer, so optimizer steps, gradient norms, replica reductions and
+// checkpoints are one linear pass instead of one per matrix.
+class ParameterStore
+{
+    private:
+        Arena memory;
+        size_t count;
+        size_t slots;
+
+        Scalar* params;
+        Scalar* grads;
+        Scalar* states;
+
+    public:
+        ParameterStore();
+        explicit ParameterStore(size_t count, size_t state_slots = 1);
+
+        size_t size() const { return count; }
+        size_t state_slots() const { return slots; }
+
+        Scalar* parameters() { return params; }
+        const Scalar* parameters() const { return params; }
+        Scalar* gradients() { return grads; }
+        const Scalar* gradients() const { return grads; }
+        Scalar* state(size_t slot = 0) { return states + slot * count; }
+        const Scalar* state(size_t slot = 0) const { return states + slot * count; }
+
+        // Reads and updates source's parameters from now on, keeping this
+        // store's gradients and state (data-parallel replicas)
+        void share_parameters(ParameterStore& source);
+
+        void scale_gradients(Scalar factor);
+        void add_gradients(const ParameterStore& other);
+        // The same over parameters [begin, end) only (one pipeline stage's)
+        void scale_gradients(Scalar factor, size_t begin, size_t end);
+        void add_gradients(const ParameterStore& other, size_t begin, size_t end);
+
+        // L2 norm over every gradient
+        double gradient_norm() const;
+        // Rescales the gradient to norm max_norm if it is longer; returns
+        // the norm before clipping
+        double clip_gradients(double max_norm);
+
+        // Zeroes every optimizer state slot
+        void clear_state();
+};
@@ -0,0 +1,87 @@
+// pipeline.hpp
+
+#pragma once
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// GPipe-style schedule over a chain of stages, each on a thread of its
+// own. A run pushes micro-batches 0 .. n - 1 through the stages in order
+// (Forward), then back through them in reverse (Backward). Handing a
+// micro-batch to the next or previous stage is a push onto a lock-free
+// single-producer, single-consumer queue between the two stages, so stage
+// s works on micro-batch m + 1 while stage s + 1 works on m. Stages
+// prefer pending backward work, which finishes micro-batches soonest.
+// Once a stage has seen every micro-batch back, it runs Finish (gradient
+// reduction over its slice) without waiting for the others.
+class Pipeline
+{
+    public:
+        enum class Phase { Forward, Backward, Finish };
+
+    private:
+        struct Stage
+        {
+            SpscQueue<size_t> forward;      // from the stage before
+            SpscQueue<size_t> backward;     // from the stage after
+            std::thread thread;
+
+            explicit Stage(size_t capacity) : forward(capacity), backward(capacity) {}
+        };
+
+        std::vector<std::unique_ptr<Stage>> stages;
+        size_t capacity;
+
+        // Current run, published under mutex
+        void (*job)(void*, Phase, size_t, size_t) = nullptr;
+        void* job_context = nullptr;
+        size_t micro_batches = 0;
+        uint64_t generation = 0;
+        size_t finished = 0;
+        bool stopping = false;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+
+        std::mutex mutex;
+        std::condition_variable start;
+        std::condition_variable done;
+
+        void stage_loop(size_t s);
+        void run_stage(size_t s, size_t count);
+        void hand_off(SpscQueue<size_t>& queue, size_t micro_batch);
+        void run(size_t count, void (*fn)(void*, Phase, size_t, size_t), void* context);
+
+        template <class F>
+        static void invoke(void* f, Phase phase, size_t stage, size_t micro_batch)
+        {
+            (*static_cast<F*>(f))(phase, stage, micro_batch);
+        }
+
+    public:
+        // Runs take at most max_micro_batches micro-batches
+        Pipeline(size_t stages, size_t max_micro_batches);
+        ~Pipeline();
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        size_t size() const { return stages.size(); }
+
+        // Calls work(phase, stage, micro_batch) on the stage threads (with
+        // micro_batch unused for Finish) and returns once every stage has
+        // finished. The first exception thrown by work is rethrown here.
+        template <class F>
+        void run(size_t micro_batches, F&& work)
+        {
+            run(micro_batches, &invoke<std::remove_reference_t<F>>,
+                const_cast<void*>(static_cast<const void*>(&work)));
+        }
+};
@@ -0,0 +1,26 @@
+// precision.hpp
+
+#pragma once
+#include <cstdint>
+
+// Floating-point type of every parameter, activation and gradient.
+// Building with PRECISION=float (-DCRNN_FLOAT32) trains and serves the
+// whole network in float32: half the memory traffic and twice the SIMD
+// lanes of the default double.
+#if defined(CRNN_FLOAT32)
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+
+// Element type tag stored in checkpoints; the value is the element size.
+// Int8 marks a quantized checkpoint (see QuantizedModel), which has a
+// layout of its own.
+enum class Precision : int32_t
+{
+    Int8 = 1,
+    Float32 = 4,
+    Float64 = 8
+};
+
+constexpr Precision SCALAR_PRECISION = sizeof(Scalar) == 4 ? Precision::Float32 : Precision::Float64;
@@ -0,0 +1,72 @@
+// quantizedmodel.hpp
+
+#pragma once
+#include "Arena.hpp"
+#include "Dataset.hpp"
+#include "Functions.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Network;
+
+// Int8 post-training quantization of a trained network, for serving.
+// Calibration runs sample rows through the float network and records the
+// largest magnitude each input channel of each layer reaches. Those
+// per-channel activation scales are folded into the weights, which are
+// then quantized per output channel: int8 weights take a quarter of the
+// memory of float32 and an eighth of float64. Activations stay int8
+// between layers. Each product accumulates in int32, and its epilogue
+// dequantizes, adds the bias, applies ReLU and requantizes for the next
+// layer in one step; only the last layer produces Scalars. Forward passes
+// run in QuantizedSessions, and the model is read-only once built.
+class QuantizedModel
+{
+    public:
+        struct QuantizedLayer
+        {
+            size_t input_size;
+            size_t output_size;
+            Activation activation;
+            // input_size rounded up to kernels::QUANT_BLOCK
+            size_t stride;
+
+            // output_size x stride in the kernels' packed panel layout; the
+            // per-channel arrays are padded to whole panels
+            std::vector<int8_t, AlignedAllocator<int8_t>> weights;
+            std::vector<int32_t> row_sums;
+            // Output channel i is scale[i] * acc + bias[i]; for hidden layers
+            // that is already in the next layer's quantized units
+            std::vector<float> scale;
+            std::vector<float> bias;
+
+            int8_t weight(size_t i, size_t k) const;
+        };
+
+    private:
+        std::vector<QuantizedLayer> layers;
+        // Features are quantized as round(x * input_scale)
+        std::vector<float> input_scale;
+
+    public:
+        // Calibrates on the first samples rows of calibration (all of them
+        // when 0). SOFTMAX is supported on the output layer only.
+        QuantizedModel(const Network& network, const Dataset& calibration, size_t samples = 0);
+        QuantizedModel(std::vector<QuantizedLayer> layers, std::vector<float> input_scale);
+
+        // A layer from int8 weights stored output_size x input_size
+        static QuantizedLayer make_layer(size_t input_size, size_t output_size, Activation activation,
+                                         const int8_t* weights, std::vector<float> scale, std::vector<float> bias);
+
+        static QuantizedModel load(const std::string& filepath);
+        void save(const std::string& filepath) const;
+
+        const std::vector<QuantizedLayer>& get_layers() const { return layers; }
+        const std::vector<float>& get_input_scale() const { return input_scale; }
+        size_t input_size() const { return layers.front().input_size; }
+        size_t output_size() const { return layers.back().output_size; }
+
+        // Resident bytes of the weights, row sums, scales and biases
+        size_t bytes() const;
+};
@@ -0,0 +1,38 @@
+// quantizedsession.hpp
+
+#pragma once
+#include "Arena.hpp"
+#include "MatrixView.hpp"
+#include "QuantizedModel.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forward passes through a QuantizedModel, the int8 counterpart of an
+// InferenceSession: two int8 buffers, one sample per row, which the layers
+// read and write alternately, and the Scalar output of the last layer.
+// Sessions only read the model, so one per thread can share it.
+class QuantizedSession
+{
+    private:
+        const QuantizedModel& model;
+        size_t width;
+
+        std::vector<int8_t, AlignedAllocator<int8_t>> buffers[2];
+        std::vector<Scalar, AlignedAllocator<Scalar>> output;
+        size_t capacity;
+
+        void plan(size_t capacity);
+        void quantize_input(ConstMatrixView input);
+
+    public:
+        explicit QuantizedSession(const QuantizedModel& model, size_t capacity = 1);
+
+        // input is features x batch, one sample per column. The result is
+        // classes x batch and stays valid until the next call.
+        ConstMatrixView forward(ConstMatrixView input);
+        // Most probable class of a single sample
+        size_t predict(ConstMatrixView input);
+        // One label per column of input
+        void predict(ConstMatrixView input, size_t* labels);
+};
@@ -0,0 +1,53 @@
+// spscqueue.hpp
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. The indices live on separate cache lines so the two sides do not
+// contend; each only writes its own and reads the other's with acquire.
+template <class T>
+class SpscQueue
+{
+    private:
+        std::vector<T> ring;
+
+        alignas(64) std::atomic<size_t> head{0};   // next slot to pop
+        alignas(64) std::atomic<size_t> tail{0};   // next slot to push
+
+        size_t advance(size_t i) const { return i + 1 == ring.size() ? 0 : i + 1; }
+
+    public:
+        // One ring slot stays empty to tell a full queue from an empty one
+        explicit SpscQueue(size_t capacity) : ring(capacity + 1) {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        size_t capacity() const { return ring.size() - 1; }
+
+        // Producer side; false when the queue is full
+        bool try_push(const T& value)
+        {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            const size_t next = advance(t);
+            if (next == head.load(std::memory_order_acquire)) return false;
+
+            ring[t] = value;
+            tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side; false when the queue is empty
+        bool try_pop(T& value)
+        {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+
+            value = ring[h];
+            head.store(advance(h), std::memory_order_release);
+            return true;
+        }
+};
@@ -0,0 +1,239 @@
+// staticnetwork.hpp
+
+#pragma once
+#include "Arena.hpp"
+#include "Functions.hpp"
+#include "InferenceModel.hpp"
+#include "MatrixView.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Activations of a Dense layer, chosen at compile time
+struct Relu
+{
+    static constexpr Activation kind = Activation::RELU;
+
+    template <size_t N>
+    static void apply(Scalar* y)
+    {
+        for (size_t i = 0; i < N; i++) y[i] = y[i] > 0 ? y[i] : Scalar(0);
+    }
+};
+
+struct Linear
+{
+    static constexpr Activation kind = Activation::LINEAR;
+
+    template <size_t N>
+    static void apply(Scalar*) {}
+};
+
+struct Softmax
+{
+    static constexpr Activation kind = Activation::SOFTMAX;
+
+    // Inline rather than through the kernel table: for a handful of
+    // outputs the call costs more than the arithmetic
+    template <size_t N>
+    static void apply(Scalar* y)
+    {
+        Scalar peak = y[0];
+        for (size_t i = 1; i < N; i++) peak = y[i] > peak ? y[i] : peak;
+
+        Scalar sum = 0;
+        for (size_t i = 0; i < N; i++)
+        {
+            y[i] = std::exp(y[i] - peak);
+            sum += y[i];
+        }
+
+        const Scalar inv = Scalar(1) / sum;
+        for (size_t i = 0; i < N; i++) y[i] *= inv;
+    }
+};
+
+// One fully connected layer with its sizes in the type. The weights are
+// stored inline and transposed (In x Out), so each input adds one
+// contiguous row to all outputs and the fixed trip counts let the compiler
+// unroll and vectorize the loops fully.
+template <size_t In, size_t Out, class Act>
+class Dense
+{
+    public:
+        static constexpr size_t inputs = In;
+        static constexpr size_t outputs = Out;
+        static constexpr size_t parameter_count = (In + 1) * Out;
+        using activation = Act;
+
+    private:
+        alignas(ALIGNMENT) Scalar WT[In][Out] = {};
+        alignas(ALIGNMENT) Scalar b[Out] = {};
+
+    public:
+        // W is Out x In, as in a Layer or a checkpoint, and bias has Out values
+        void set(const Scalar* W, const Scalar* bias)
+        {
+            for (size_t i = 0; i < Out; i++)
+            {
+                for (size_t k = 0; k < In; k++) WT[k][i] = W[i * In + k];
+                b[i] = bias[i];
+            }
+        }
+
+        // x and y must not overlap
+        void forward(const Scalar* x, Scalar* y) const
+        {
+            alignas(ALIGNMENT) Scalar acc[Out];
+            for (size_t i = 0; i < Out; i++) acc[i] = b[i];
+
+            for (size_t k = 0; k < In; k++)
+            {
+                const Scalar xk = x[k];
+                for (size_t i = 0; i < Out; i++) acc[i] += WT[k][i] * xk;
+            }
+
+            for (size_t i = 0; i < Out; i++) y[i] = acc[i];
+            Act::template apply<Out>(y);
+        }
+};
+
+// A network whose topology is fixed at compile time, e.g.
+//
+//     StaticNetwork<Dense<24, 64, Relu>, Dense<64, 32, Relu>, Dense<32, 2, Softmax>>
+//
+// Every size is a constant, the weights and the two ping-pong activation
+// buffers live inside the object (on the stack, or wherever it is placed),
+// and forward passes make no allocations, no size checks and no activation
+// switches, so single-sample latency comes down to the arithmetic. It is
+// inference only and reads the same .crnn checkpoints as Network, checking
+// each layer's shape and activation against the type.
+template <class... Layers>
+class StaticNetwork
+{
+    static_assert(sizeof...(Layers) > 0, "StaticNetwork needs at least one layer");
+
+    private:
+        template <class First, class... Rest>
+        static constexpr bool connected()
+        {
+            if constexpr (sizeof...(Rest) == 0)
+            {
+                return true;
+            }
+            else
+            {
+                using Next = std::tuple_element_t<0, std::tuple<Rest...>>;
+                return First::outputs == Next::inputs && connected<Rest...>();
+            }
+        }
+
+        static_assert(connected<Layers...>(), "Each layer's inputs must match the outputs of the layer before it");
+
+        using LayerTuple = std::tuple<Layers...>;
+
+    public:
+        static constexpr size_t layer_count = sizeof...(Layers);
+        static constexpr size_t input_size = std::tuple_element_t<0, LayerTuple>::inputs;
+        static constexpr size_t output_size = std::tuple_element_t<layer_count - 1, LayerTuple>::outputs;
+        static constexpr size_t parameter_count = (Layers::parameter_count + ...);
+
+    private:
+        static constexpr size_t width = std::max({ Layers::outputs... });
+
+        LayerTuple layers;
+        alignas(ALIGNMENT) Scalar buffers[2][width] = {};
+        alignas(ALIGNMENT) Scalar gathered[input_size] = {};
+
+        template <size_t I>
+        const Scalar* run(const Scalar* x)
+        {
+            if constexpr (I == layer_count)
+            {
+                return x;
+            }
+            else
+            {
+                std::get<I>(layers).forward(x, buffers[I % 2]);
+                return run<I + 1>(buffers[I % 2]);
+            }
+        }
+
+        template <size_t I>
+        void load_layers(const std::vector<ModelIO::LayerShape>& shapes, const Scalar* params)
+        {
+            if constexpr (I < layer_count)
+            {
+                using L = std::tuple_element_t<I, LayerTuple>;
+                const ModelIO::LayerShape& shape = shapes[I];
+
+                if (shape.input_size != L::inputs || shape.output_size != L::outputs ||
+                    shape.activation != L::activation::kind)
+                {
+                    throw std::runtime_error("Error: Layer " + std::to_string(I) + " architecture mismatch");
+                }
+
+                std::get<I>(layers).set(params, params + L::inputs * L::outputs);
+                load_layers<I + 1>(shapes, params + L::parameter_count);
+            }
+        }
+
+    public:
+        // Reads only the weights of a checkpoint (see InferenceModel::load)
+        void load(const std::string& filepath) { load(InferenceModel::load(filepath)); }
+
+        // InferenceModel(network) hands over a trained Network's weights
+        void load(const InferenceModel& model)
+        {
+            const std::vector<ModelIO::LayerShape>& shapes = model.get_layers();
+            if (shapes.size() != layer_count)
+            {
+                throw std::runtime_error("Error: Number of layers mismatch. Expected " +
+                                         std::to_string(layer_count) + ", found " + std::to_string(shapes.size()));
+            }
+
+            load_layers<0>(shapes, model.parameters());
+        }
+
+        // Scores of one sample of input_size features; valid until the next call
+        const Scalar* forward(const Scalar* input) { return run<0>(input); }
+
+        // input is input_size x 1; the result is output_size x 1
+        ConstMatrixView forward(ConstMatrixView input)
+        {
+            if (input.rows() != input_size || input.cols() != 1)
+            {
+                throw std::invalid_argument(
+                    "Error: Input is " + std::to_string(input.rows()) + "x" + std::to_string(input.cols()) +
+                    ", the network expects " + std::to_string(input_size) + "x1"
+                );
+            }
+
+            const Scalar* x = input.data();
+            if (input.stride() != 1)
+            {
+                for (size_t k = 0; k < input_size; k++) gathered[k] = input.get(k, 0);
+                x = gathered;
+            }
+
+            return ConstMatrixView(forward(x), output_size, 1);
+        }
+
+        // Most probable class of one sample
+        size_t predict(const Scalar* input)
+        {
+            const Scalar* scores = forward(input);
+            return static_cast<size_t>(std::max_element(scores, scores + output_size) - scores);
+        }
+
+        size_t predict(ConstMatrixView input)
+        {
+            const ConstMatrixView scores = forward(input);
+            return static_cast<size_t>(std::max_element(scores.data(), scores.data() + output_size) - scores.data());
+        }
+};
@@ -0,0 +1,77 @@
+// threadpool.hpp
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads that run index-parallel loops. The calling
+// thread takes part in every loop, so a pool of size n has n - 1 workers.
+// One loop runs at a time: a loop started from inside another one, or
+// while the pool is busy with another caller's loop, runs inline.
+class ThreadPool
+{
+    private:
+        // Changed only by resize, under submit_mutex; thread_count mirrors
+        // its size for size(), which takes no lock
+        std::vector<std::thread> workers;
+        std::atomic<size_t> thread_count{1};
+
+        std::mutex submit_mutex;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        // Current loop, published under mutex
+        void (*job)(void*, size_t) = nullptr;
+        void* job_context = nullptr;
+        size_t job_size = 0;
+        std::atomic<size_t> next_index{0};
+        size_t active = 0;
+        uint64_t generation = 0;
+        bool stopping = false;
+        std::exception_ptr error;
+
+        void start(size_t threads);
+        void stop();
+        // seen: the generation current when the worker was started
+        void worker_loop(uint64_t seen);
+        void drain();
+        void run(size_t count, void (*fn)(void*, size_t), void* context);
+
+        template <class F>
+        static void invoke(void* f, size_t i) { (*static_cast<F*>(f))(i); }
+
+    public:
+        explicit ThreadPool(size_t threads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Threads taking part in a loop, the caller included
+        size_t size() const { return thread_count.load(std::memory_order_relaxed); }
+        void resize(size_t threads);
+
+        // Calls f(i) for every i in [0, count), spread over the pool, and
+        // returns when all calls have finished. The first exception thrown
+        // by f is rethrown here.
+        template <class F>
+        void parallel_for(size_t count, F&& f)
+        {
+            run(count, &invoke<std::remove_reference_t<F>>, const_cast<void*>(static_cast<const void*>(&f)));
+        }
+
+        // Loops started from the calling thread run inline from now on, so
+        // a background thread never takes the pool from the trainer
+        static void run_inline_on_this_thread();
+
+        // Shared pool, sized from CRNN_THREADS or the hardware concurrency
+        static ThreadPool& global();
+};
@@ -43,7 +43,7 @@ private:
     void plot_loss(std::vector<std::vector<char>>& grid, std::vector<std::vector<std::string>>& colors, 
                    double min_loss, double max_loss, double range) {
         size_t history_size = loss_history.size();
-        size_t points_to_plot = std::min(history_size, graph_width);
+        size_t points_to_plot = std::min(history_size, graph_width - 1);
         
         if (points_to_plot > 1) {
             std::vector<size_t> y_positions(points_to_plot);
@@ -100,7 +100,7 @@ private:
     void plot_accuracy(std::vector<std::vector<char>>& grid, std::vector<std::vector<std::string>>& colors,
                        double min_acc, double max_acc, double range) {
         size_t history_size = accuracy_history.size();
-        size_t points_to_plot = std::min(history_size, graph_width);
+        size_t points_to_plot = std::min(history_size, graph_width - 1);
         
         if (points_to_plot > 1) {
             std::vector<size_t> y_positions(points_to_plot);
@@ -269,7 +269,8 @@ private:
     size_t graph_height = 20;
 
 public:
-    void log_epoch(size_t epoch, size_t total_epochs, double accuracy, double loss) {
+    // A validation_accuracy of 0 or more is appended to the epoch line
+    void log_epoch(size_t epoch, size_t total_epochs, double accuracy, double loss, double validation_accuracy = -1.0) {
         if (accuracy > max_accuracy) {
             max_accuracy = accuracy;
         }
@@ -280,7 +281,11 @@ public:
         std::cout << "\033[1mEpoch " << epoch << "/" << total_epochs 
                   << " | Current Accuracy: " << std::fixed << std::setprecision(4) << accuracy * 100 << "%"
                   << " | Max Accuracy: " << std::fixed << std::setprecision(4) << max_accuracy * 100 << "%"
-                  << " | Loss: " << std::fixed << std::setprecision(6) << loss << "\033[0m" << std::endl;
+                  << " | Loss: " << std::fixed << std::setprecision(6) << loss;
+        if (validation_accuracy >= 0.0) {
+            std::cout << " | Validation: " << std::fixed << std::setprecision(4) << validation_accuracy * 100 << "%";
+        }
+        std::cout << "\033[0m" << std::endl;
         
         loss_graph.draw();
         std::cout.flush();
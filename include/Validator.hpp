@@ -0,0 +1,84 @@
+// validator.hpp
+
+#pragma once
+#include "Dataset.hpp"
+#include "ModelIO.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Network;
+
+// Scores a held-out dataset on a background thread while training runs.
+// submit() copies the network's weights (and the rest of its checkpoint)
+// into whichever of two snapshot buffers the evaluator is not reading and
+// returns. The evaluator thread loads the snapshot into a private network
+// and runs batched inference over the dataset. When the accuracy beats
+// the best seen so far by min_delta, it writes that exact snapshot as the
+// checkpoint. A snapshot submitted while an older one is still waiting
+// replaces it, so a slow evaluation skips epochs instead of holding up
+// training. Write errors are rethrown from the next submit(), poll() or
+// finish().
+class Validator
+{
+    public:
+        struct Result
+        {
+            size_t epoch;
+            double accuracy;
+            double loss;
+            // A new best; its snapshot is the checkpoint now
+            bool improved;
+        };
+
+    private:
+        const Dataset& dataset;
+        size_t batch_size;
+        std::string checkpoint_path;
+        double min_delta;
+        double best_accuracy;
+
+        // Same layers as the trained network, with weights of its own
+        std::unique_ptr<Network> evaluator;
+
+        ModelIO::Snapshot buffers[2];
+        size_t epochs[2] = { 0, 0 };
+
+        // Index submit() fills next; the evaluator only reads the other one
+        size_t spare = 0;
+        bool pending = false;
+        bool evaluating = false;
+        bool stopping = false;
+        std::deque<Result> results;
+        std::exception_ptr error;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::thread thread;
+
+        void run();
+        Result evaluate(ModelIO::Snapshot& snapshot, size_t epoch);
+        void rethrow_error();
+
+    public:
+        // The dataset must outlive the validator and not change while it runs
+        Validator(const Network& network, const Dataset& dataset,
+                  const std::string& checkpoint_path, size_t batch_size = 256);
+        // Finishes any pending evaluation
+        ~Validator();
+
+        Validator(const Validator&) = delete;
+        Validator& operator=(const Validator&) = delete;
+
+        void submit(const Network& network, size_t epoch);
+        // Takes the oldest result not yet polled, without waiting
+        bool poll(Result& result);
+        // Blocks until every submitted snapshot has been evaluated
+        void finish();
+};
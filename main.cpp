@@ -2,6 +2,7 @@
 #include "include/Dataset.hpp"
 #include "include/Matrix.hpp"
 #include <iostream>
+#include <thread>
 #include <vector>
 
 int main() {
@@ -20,16 +21,15 @@ int main() {
     
     network.load("checkpoints/best_btc.crnn");
     
+    // Chunks of rows as one product per layer, on every core
+    network.set_num_threads(std::thread::hardware_concurrency());
+    std::vector<size_t> predicted = network.predict_batch(dataset);
+
     size_t correct = 0;
 
     for (size_t i = 0; i < dataset.size(); i++) 
     {
-        network.forward(dataset.get_input(i));
-        const Matrix& output = network.get_output();
-        size_t predicted = network.argmax(output);
-        size_t actual = dataset.get_output(i);
-        
-        if (predicted == actual) correct++;
+        if (predicted[i] == dataset.get_output(i)) correct++;
     }
     
     double accuracy = static_cast<double>(correct) / dataset.size();
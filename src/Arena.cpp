@@ -0,0 +1,124 @@
+// arena.cpp
+
+#include "Arena.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+void* aligned_allocate(size_t bytes)
+{
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, ALIGNMENT, bytes == 0 ? ALIGNMENT : bytes) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void aligned_free(void* ptr)
+{
+    std::free(ptr);
+}
+
+Arena::Arena() : base(nullptr), capacity_bytes(0), used_bytes(0), mapped(false) {}
+
+Arena::Arena(size_t bytes) : base(nullptr), capacity_bytes(bytes), used_bytes(0), mapped(false)
+{
+    if (bytes == 0) return;
+
+#if defined(__linux__)
+    if (bytes >= HUGE_PAGE_THRESHOLD)
+    {
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr != MAP_FAILED)
+        {
+            madvise(ptr, bytes, MADV_HUGEPAGE);
+            base = static_cast<Scalar*>(ptr);
+            mapped = true;
+            return;
+        }
+    }
+#endif
+
+    base = static_cast<Scalar*>(aligned_allocate(bytes));
+    std::memset(base, 0, bytes);
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void Arena::release()
+{
+    if (base == nullptr) return;
+
+#if defined(__linux__)
+    if (mapped)
+    {
+        munmap(base, capacity_bytes);
+    }
+    else
+#endif
+    {
+        aligned_free(base);
+    }
+
+    base = nullptr;
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : base(other.base), capacity_bytes(other.capacity_bytes), used_bytes(other.used_bytes), mapped(other.mapped)
+{
+    other.base = nullptr;
+    other.capacity_bytes = 0;
+    other.used_bytes = 0;
+    other.mapped = false;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+
+        base = other.base;
+        capacity_bytes = other.capacity_bytes;
+        used_bytes = other.used_bytes;
+        mapped = other.mapped;
+
+        other.base = nullptr;
+        other.capacity_bytes = 0;
+        other.used_bytes = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+size_t Arena::footprint(size_t count)
+{
+    return (count * sizeof(Scalar) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+Scalar* Arena::allocate(size_t count)
+{
+    const size_t bytes = footprint(count);
+
+    if (used_bytes + bytes > capacity_bytes)
+    {
+        throw std::runtime_error(
+            "Error: Arena exhausted. Requested " + std::to_string(bytes) + " bytes, " +
+            std::to_string(capacity_bytes - used_bytes) + " available"
+        );
+    }
+
+    Scalar* ptr = reinterpret_cast<Scalar*>(reinterpret_cast<char*>(base) + used_bytes);
+    used_bytes += bytes;
+    return ptr;
+}
@@ -0,0 +1,102 @@
+// blas.cpp
+
+#include "Blas.hpp"
+
+#if defined(CRNN_BLAS_ACCELERATE)
+#include <Accelerate/Accelerate.h>
+#define CRNN_CBLAS 1
+#elif defined(CRNN_BLAS)
+#include <cblas.h>
+#define CRNN_CBLAS 1
+#endif
+
+#ifndef CRNN_BLAS_NAME
+#define CRNN_BLAS_NAME "builtin"
+#endif
+
+namespace blas
+{
+    const char* backend() { return CRNN_BLAS_NAME; }
+
+#ifdef CRNN_CBLAS
+    namespace
+    {
+        CBLAS_TRANSPOSE to_cblas(gemm::Trans trans)
+        {
+            return trans == gemm::Trans::No ? CblasNoTrans : CblasTrans;
+        }
+
+        // A single output column is a matrix-vector product. op(B) is then
+        // K x 1: a column of B (stride ldb) or a row of B^T (stride 1).
+        template <class T, class Gemv, class Gemm>
+        void dispatch(Gemv gemv, Gemm gemm_fn,
+                      gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+                      T alpha, const T* A, size_t lda, const T* B, size_t ldb,
+                      T beta, T* C, size_t ldc)
+        {
+            if (M == 0 || N == 0) return;
+
+            if (K == 0)
+            {
+                // Leading dimensions of empty operands are not valid cblas input
+                gemm::gemm(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+                return;
+            }
+
+            if (N == 1)
+            {
+                const size_t stored_rows = trans_a == gemm::Trans::No ? M : K;
+                const size_t stored_cols = trans_a == gemm::Trans::No ? K : M;
+                const size_t incx = trans_b == gemm::Trans::No ? ldb : 1;
+
+                gemv(CblasRowMajor, to_cblas(trans_a), int(stored_rows), int(stored_cols),
+                     alpha, A, int(lda), B, int(incx), beta, C, int(ldc));
+                return;
+            }
+
+            gemm_fn(CblasRowMajor, to_cblas(trans_a), to_cblas(trans_b), int(M), int(N), int(K),
+                    alpha, A, int(lda), B, int(ldb), beta, C, int(ldc));
+        }
+    }
+
+    void gemm(gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+              float alpha, const float* A, size_t lda,
+              const float* B, size_t ldb,
+              float beta, float* C, size_t ldc,
+              const gemm::Epilogue<float>& epilogue)
+    {
+        dispatch(cblas_sgemv, cblas_sgemm, trans_a, trans_b, M, N, K,
+                 alpha, A, lda, B, ldb, beta, C, ldc);
+        if (!epilogue.empty()) gemm::apply_epilogue(M, N, epilogue, C, ldc);
+    }
+
+    void gemm(gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+              double alpha, const double* A, size_t lda,
+              const double* B, size_t ldb,
+              double beta, double* C, size_t ldc,
+              const gemm::Epilogue<double>& epilogue)
+    {
+        dispatch(cblas_dgemv, cblas_dgemm, trans_a, trans_b, M, N, K,
+                 alpha, A, lda, B, ldb, beta, C, ldc);
+        if (!epilogue.empty()) gemm::apply_epilogue(M, N, epilogue, C, ldc);
+    }
+#else
+    void gemm(gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+              float alpha, const float* A, size_t lda,
+              const float* B, size_t ldb,
+              float beta, float* C, size_t ldc,
+              const gemm::Epilogue<float>& epilogue)
+    {
+        gemm::gemm(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+    }
+
+    void gemm(gemm::Trans trans_a, gemm::Trans trans_b, size_t M, size_t N, size_t K,
+              double alpha, const double* A, size_t lda,
+              const double* B, size_t ldb,
+              double beta, double* C, size_t ldc,
+              const gemm::Epilogue<double>& epilogue)
+    {
+        gemm::gemm(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+    }
+#endif
+}
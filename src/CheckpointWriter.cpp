@@ -0,0 +1,79 @@
+// checkpointwriter.cpp
+
+#include "CheckpointWriter.hpp"
+#include "Network.hpp"
+
+CheckpointWriter::CheckpointWriter() : thread(&CheckpointWriter::run, this) {}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void CheckpointWriter::publish(const Network& network, const std::string& filepath)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rethrow_error();
+
+    // The writer only ever holds the lock to swap buffers, so this copy
+    // never waits on the disk
+    ModelIO::capture(network, buffers[spare]);
+    paths[spare] = filepath;
+    pending = true;
+
+    wake.notify_one();
+}
+
+void CheckpointWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return !pending && !writing; });
+    rethrow_error();
+}
+
+void CheckpointWriter::rethrow_error()
+{
+    if (error)
+    {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void CheckpointWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        wake.wait(lock, [this] { return pending || stopping; });
+        if (!pending) break;
+
+        const size_t current = spare;
+        spare = 1 - spare;
+        pending = false;
+        writing = true;
+
+        lock.unlock();
+        std::exception_ptr failure;
+        try
+        {
+            ModelIO::write_snapshot(buffers[current], paths[current]);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+        lock.lock();
+
+        if (failure) error = failure;
+        writing = false;
+        idle.notify_all();
+    }
+}
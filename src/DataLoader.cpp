@@ -0,0 +1,210 @@
+// dataloader.cpp
+
+#include "DataLoader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+DataLoader::DataLoader(const Dataset& dataset, size_t batch_size, size_t prefetch,
+                       size_t threads, bool standardize)
+    : dataset(dataset),
+      batch_size(std::min(batch_size, dataset.size())),
+      standardize(standardize),
+      rng(std::random_device{}())
+{
+    if (batch_size == 0 || dataset.size() == 0)
+    {
+        throw std::invalid_argument("Error: DataLoader needs a non-empty dataset and a batch size of at least 1");
+    }
+    if (prefetch == 0 || threads == 0)
+    {
+        throw std::invalid_argument("Error: DataLoader needs at least one slot and one producer thread");
+    }
+
+    batches_per_epoch = (dataset.size() + this->batch_size - 1) / this->batch_size;
+
+    for (std::vector<size_t>& o : order)
+    {
+        o.resize(dataset.size());
+        std::iota(o.begin(), o.end(), size_t(0));
+    }
+
+    if (standardize)
+    {
+        compute_statistics();
+    }
+
+    slots.resize(prefetch);
+    for (Slot& slot : slots)
+    {
+        slot.input = Matrix(dataset.features(), this->batch_size);
+        slot.labels.resize(this->batch_size);
+    }
+
+    for (size_t t = 0; t < threads; t++)
+    {
+        producers.emplace_back(&DataLoader::produce, this);
+    }
+}
+
+DataLoader::~DataLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+}
+
+void DataLoader::compute_statistics()
+{
+    const size_t features = dataset.features();
+    std::vector<double> sum(features, 0.0), sum_sq(features, 0.0);
+
+    for (size_t i = 0; i < dataset.size(); i++)
+    {
+        const Scalar* sample = dataset.sample(i);
+        for (size_t f = 0; f < features; f++)
+        {
+            sum[f] += sample[f];
+            sum_sq[f] += double(sample[f]) * sample[f];
+        }
+    }
+
+    mean.resize(features);
+    inv_std.resize(features);
+    for (size_t f = 0; f < features; f++)
+    {
+        const double m = sum[f] / dataset.size();
+        const double variance = std::max(sum_sq[f] / dataset.size() - m * m, 0.0);
+
+        mean[f] = Scalar(m);
+        // Constant features are centred but not scaled
+        inv_std[f] = variance > 0.0 ? Scalar(1.0 / std::sqrt(variance)) : Scalar(1);
+    }
+}
+
+void DataLoader::begin_epoch()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (next_take != epoch_end)
+    {
+        throw std::runtime_error("Error: begin_epoch() called before the current epoch was consumed");
+    }
+    epoch_end += batches_per_epoch;
+}
+
+bool DataLoader::next(Batch& batch)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (next_take == epoch_end) return false;
+
+    const size_t sequence = next_take++;
+    Slot& slot = slots[sequence % slots.size()];
+    changed.wait(lock, [&] { return slot.state == SlotState::Ready && slot.sequence == sequence; });
+
+    slot.state = SlotState::InUse;
+    batch.input = ConstMatrixView(slot.input.data(), dataset.features(), slot.count);
+    batch.labels = slot.labels.data();
+    batch.slot = sequence % slots.size();
+    return true;
+}
+
+void DataLoader::release(const Batch& batch)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[batch.slot].state = SlotState::Free;
+    }
+    changed.notify_all();
+}
+
+void DataLoader::produce()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        changed.wait(lock, [this]
+        {
+            return stopping || (!shuffling && slots[next_fill % slots.size()].state == SlotState::Free);
+        });
+        if (stopping) return;
+
+        const size_t sequence = next_fill;
+        const size_t epoch = sequence / batches_per_epoch;
+        std::vector<size_t>& epoch_order = order[epoch % 2];
+
+        if (epoch >= prepared_epochs)
+        {
+            // Reshuffle this epoch's order once gathers from two epochs
+            // back, which share the buffer, are done with it
+            if (active[epoch % 2] != 0)
+            {
+                changed.wait(lock);
+                continue;
+            }
+
+            shuffling = true;
+            lock.unlock();
+            std::shuffle(epoch_order.begin(), epoch_order.end(), rng);
+            lock.lock();
+            shuffling = false;
+            prepared_epochs = epoch + 1;
+
+            changed.notify_all();
+            continue;
+        }
+
+        Slot& slot = slots[sequence % slots.size()];
+        slot.state = SlotState::Filling;
+        slot.sequence = sequence;
+        next_fill++;
+        active[epoch % 2]++;
+
+        lock.unlock();
+        gather(slot, epoch_order, sequence % batches_per_epoch);
+        lock.lock();
+
+        active[epoch % 2]--;
+        slot.state = SlotState::Ready;
+        changed.notify_all();
+    }
+}
+
+void DataLoader::gather(Slot& slot, const std::vector<size_t>& epoch_order, size_t batch)
+{
+    const size_t start = batch * batch_size;
+    const size_t count = std::min(batch_size, dataset.size() - start);
+    const size_t features = dataset.features();
+
+    // Contiguous features x count, so partial batches stay dense
+    MatrixView out(slot.input.data(), features, count);
+
+    for (size_t j = 0; j < count; j++)
+    {
+        const size_t row = epoch_order[start + j];
+        const Scalar* sample = dataset.sample(row);
+        slot.labels[j] = dataset.label(row);
+
+        if (standardize)
+        {
+            for (size_t f = 0; f < features; f++) out.set(f, j, (sample[f] - mean[f]) * inv_std[f]);
+        }
+        else
+        {
+            for (size_t f = 0; f < features; f++) out.set(f, j, sample[f]);
+        }
+    }
+
+    slot.count = count;
+}
@@ -9,29 +9,80 @@
 #include <stdexcept>
 #include <cctype>
 
-Dataset::Dataset(std::vector<Matrix> inputs, std::vector<size_t> outputs)
+static Matrix stack_rows(const std::vector<Matrix>& samples)
 {
-    if (inputs.size() != outputs.size())
+    const size_t features = samples.empty() ? 0 : samples[0].rows() * samples[0].cols();
+    Matrix stacked(samples.size(), features);
+
+    for (size_t i = 0; i < samples.size(); i++)
     {
-        throw std::invalid_argument("Error: Inputs and outputs must have the same size");
+        if (samples[i].rows() * samples[i].cols() != features)
+        {
+            throw std::invalid_argument(
+                "Error: Input " + std::to_string(i) + " has " + std::to_string(samples[i].rows() * samples[i].cols()) +
+                " values, expected " + std::to_string(features)
+            );
+        }
+        std::copy(samples[i].data(), samples[i].data() + features, stacked.data() + i * features);
     }
 
-    this->inputs = inputs;
-    this->outputs = outputs;
+    return stacked;
+}
+
+Dataset::Dataset(const std::vector<Matrix>& inputs, std::vector<size_t> outputs)
+    : Dataset(stack_rows(inputs), std::move(outputs)) {}
+
+Dataset::Dataset(Matrix inputs, std::vector<size_t> outputs)
+    : inputs(std::move(inputs)), outputs(std::move(outputs))
+{
+    if (this->inputs.rows() != this->outputs.size())
+    {
+        throw std::invalid_argument("Error: Inputs and outputs must have the same size");
+    }
 
-    perm_idx.reserve(inputs.size());
-    for (size_t i = 0; i < inputs.size(); i++)
+    perm_idx.reserve(this->outputs.size());
+    for (size_t i = 0; i < this->outputs.size(); i++)
     {
         perm_idx.push_back(i);
     }
 }
 
-const size_t Dataset::size() const { return inputs.size(); }
+const size_t Dataset::size() const { return inputs.rows(); }
+
+size_t Dataset::features() const { return inputs.cols(); }
+
+ConstMatrixView Dataset::get_input(size_t index) const
+{
+    return ConstMatrixView(inputs.data() + perm_idx[index] * inputs.cols(), inputs.cols(), 1, 1);
+}
+
+void Dataset::get_batch(size_t start, MatrixView out) const
+{
+    if (out.rows() != inputs.cols() || start + out.cols() > size())
+    {
+        throw std::out_of_range(
+            "Error: Batch of " + std::to_string(out.cols()) + " samples at " + std::to_string(start) +
+            " does not fit a dataset of " + std::to_string(size()) + " samples with " +
+            std::to_string(inputs.cols()) + " features"
+        );
+    }
 
-const Matrix& Dataset::get_input(size_t index) const { return inputs[perm_idx[index]]; }
+    for (size_t j = 0; j < out.cols(); j++)
+    {
+        const Scalar* sample = inputs.data() + perm_idx[start + j] * inputs.cols();
+        for (size_t f = 0; f < out.rows(); f++)
+        {
+            out.set(f, j, sample[f]);
+        }
+    }
+}
 
 const size_t Dataset::get_output(size_t index) const { return outputs[perm_idx[index]]; }
 
+const Scalar* Dataset::sample(size_t row) const { return inputs.data() + row * inputs.cols(); }
+
+size_t Dataset::label(size_t row) const { return outputs[row]; }
+
 void Dataset::shuffle() 
 { 
     std::shuffle(perm_idx.begin(), perm_idx.end(), std::mt19937{std::random_device{}()});
@@ -95,7 +146,8 @@ Dataset Dataset::from_csv(
     }
     size_t output_index = std::distance(headers.begin(), output_it);
 
-    std::vector<Matrix> inputs;
+    std::vector<Scalar> input_values;
+    size_t samples = 0;
     std::vector<size_t> outputs;
     std::map<std::string, size_t> class_map;
     size_t next_class_index = 0;
@@ -117,8 +169,6 @@ Dataset Dataset::from_csv(
                                   " columns, expected " + std::to_string(headers.size()));
         }
 
-        std::vector<double> input_values;
-        input_values.reserve(input_indices.size());
         for (size_t idx : input_indices) {
             try {
                 input_values.push_back(std::stod(values[idx]));
@@ -129,7 +179,7 @@ Dataset Dataset::from_csv(
             }
         }
 
-        inputs.push_back(Matrix(input_values.size(), 1, input_values));
+        samples++;
 
         std::string output_value = values[output_index];
         
@@ -185,9 +235,9 @@ Dataset Dataset::from_csv(
 
     std::cout << "Dataset loaded successfully" << std::endl;
 
-    if (inputs.empty()) {
+    if (samples == 0) {
         throw std::runtime_error("Error: No data rows found in CSV file");
     }
 
-    return Dataset(inputs, outputs);
+    return Dataset(Matrix(samples, input_indices.size(), std::move(input_values)), std::move(outputs));
 }
\ No newline at end of file
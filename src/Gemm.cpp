@@ -0,0 +1,496 @@
+// gemm.cpp
+
+#include "Gemm.hpp"
+#include "Arena.hpp"
+#include "Kernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace gemm
+{
+    namespace
+    {
+        // A matrix operand addressed through row and column strides, so the
+        // same code reads X and X^T: element (i, j) is at p[i * rs + j * cs].
+        template <class T>
+        struct Operand
+        {
+            const T* p;
+            size_t rs, cs;
+
+            Operand(const T* p, size_t ld, Trans trans)
+                : p(p), rs(trans == Trans::No ? ld : 1), cs(trans == Trans::No ? 1 : ld) {}
+
+            T operator()(size_t i, size_t j) const { return p[i * rs + j * cs]; }
+            Operand<T> offset(size_t i, size_t j) const { Operand<T> o = *this; o.p += i * rs + j * cs; return o; }
+        };
+
+        // The micro-kernel and its register tile. Scalar products use the
+        // active kernel table's, built for the host's vector width; the
+        // other precision of the public API uses the portable MR x NR one.
+        template <class T>
+        struct Tile
+        {
+            size_t mr, nr;
+            void (*kernel)(size_t kc, const T* Ap, const T* Bp, T beta, T* C, size_t ldc);
+        };
+
+        // Packs an mc x kc block of A into mr-row micro-panels laid out
+        // k-major, so the micro-kernel reads A sequentially. alpha is folded
+        // in here and rows past mc are zero-padded.
+        template <class T>
+        void pack_A(size_t mc, size_t kc, size_t MR, T alpha, const Operand<T>& A, T* Ap)
+        {
+            for (size_t i = 0; i < mc; i += MR)
+            {
+                const size_t mr = std::min(MR, mc - i);
+
+                for (size_t k = 0; k < kc; k++)
+                {
+                    for (size_t r = 0; r < mr; r++)
+                    {
+                        Ap[r] = alpha * A(i + r, k);
+                    }
+                    for (size_t r = mr; r < MR; r++)
+                    {
+                        Ap[r] = 0.0;
+                    }
+                    Ap += MR;
+                }
+            }
+        }
+
+        // Packs a kc x nc block of B into nr-column micro-panels laid out
+        // k-major, zero-padding columns past nc.
+        template <class T>
+        void pack_B(size_t kc, size_t nc, size_t NR, const Operand<T>& B, T* Bp)
+        {
+            for (size_t j = 0; j < nc; j += NR)
+            {
+                const size_t nr = std::min(NR, nc - j);
+
+                for (size_t k = 0; k < kc; k++)
+                {
+                    for (size_t c = 0; c < nr; c++)
+                    {
+                        Bp[c] = B(k, j + c);
+                    }
+                    for (size_t c = nr; c < NR; c++)
+                    {
+                        Bp[c] = 0.0;
+                    }
+                    Bp += NR;
+                }
+            }
+        }
+
+        // Portable MR x NR register tile: C = beta * C + Ap * Bp over kc.
+        template <class T>
+        void micro_kernel(size_t kc, const T* Ap, const T* Bp, T beta, T* C, size_t ldc)
+        {
+            T acc[MR][NR] = {};
+
+            for (size_t k = 0; k < kc; k++)
+            {
+                for (size_t r = 0; r < MR; r++)
+                {
+                    const T a = Ap[r];
+                    for (size_t c = 0; c < NR; c++)
+                    {
+                        acc[r][c] += a * Bp[c];
+                    }
+                }
+                Ap += MR;
+                Bp += NR;
+            }
+
+            for (size_t r = 0; r < MR; r++)
+            {
+                T* c_row = C + r * ldc;
+                for (size_t c = 0; c < NR; c++)
+                {
+                    c_row[c] = beta == 0 ? acc[r][c] : beta * c_row[c] + acc[r][c];
+                }
+            }
+        }
+
+        template <class T>
+        Tile<T> tile() { return { MR, NR, &micro_kernel<T> }; }
+
+        template <>
+        Tile<Scalar> tile<Scalar>()
+        {
+            const kernels::GemmKernel& k = kernels::active().gemm;
+            return { k.mr, k.nr, k.run };
+        }
+
+        template <class T>
+        void epilogue_rows(size_t m, size_t n, const Epilogue<T>& ep, T* C, size_t ldc)
+        {
+            for (size_t r = 0; r < m; r++)
+            {
+                T* c_row = C + r * ldc;
+
+                if (ep.bias)
+                {
+                    const T b = ep.bias[r];
+                    for (size_t c = 0; c < n; c++) c_row[c] += b;
+                }
+
+                if (ep.out)
+                {
+                    T* o_row = ep.out + r * ep.ldo;
+                    if (ep.activation == Activation::Relu)
+                    {
+                        for (size_t c = 0; c < n; c++) o_row[c] = c_row[c] > 0 ? c_row[c] : T(0);
+                    }
+                    else if (o_row != c_row)
+                    {
+                        for (size_t c = 0; c < n; c++) o_row[c] = c_row[c];
+                    }
+                }
+            }
+        }
+
+        // Stores the mr x nr corner of a full tile computed into ab (rows
+        // ldab apart), for tiles on the edges of C
+        template <class T>
+        void store_tile(size_t mr, size_t nr, const T* ab, size_t ldab, T beta, T* C, size_t ldc)
+        {
+            for (size_t r = 0; r < mr; r++)
+            {
+                T* c_row = C + r * ldc;
+                const T* ab_row = ab + r * ldab;
+
+                if (beta == 0.0)
+                {
+                    for (size_t c = 0; c < nr; c++) c_row[c] = ab_row[c];
+                }
+                else if (beta == 1.0)
+                {
+                    for (size_t c = 0; c < nr; c++) c_row[c] += ab_row[c];
+                }
+                else
+                {
+                    for (size_t c = 0; c < nr; c++) c_row[c] = beta * c_row[c] + ab_row[c];
+                }
+            }
+        }
+
+        // ep is set only for the last K block, when the tiles are final
+        template <class T>
+        void macro_kernel(const Tile<T>& shape, size_t mc, size_t nc, size_t kc,
+                          const T* Ap, const T* Bp,
+                          T beta, T* C, size_t ldc,
+                          const Epilogue<T>* ep)
+        {
+            alignas(64) T ab[kernels::GEMM_TILE_MAX];
+
+            for (size_t j = 0; j < nc; j += shape.nr)
+            {
+                const size_t nr = std::min(shape.nr, nc - j);
+                const T* b_panel = Bp + j * kc;
+
+                for (size_t i = 0; i < mc; i += shape.mr)
+                {
+                    const size_t mr = std::min(shape.mr, mc - i);
+                    T* c_tile = C + i * ldc + j;
+
+                    if (mr == shape.mr && nr == shape.nr)
+                    {
+                        shape.kernel(kc, Ap + i * kc, b_panel, beta, c_tile, ldc);
+                    }
+                    else
+                    {
+                        shape.kernel(kc, Ap + i * kc, b_panel, T(0), ab, shape.nr);
+                        store_tile(mr, nr, ab, shape.nr, beta, c_tile, ldc);
+                    }
+
+                    if (ep) epilogue_rows(mr, nr, ep->offset(i, j), c_tile, ldc);
+                }
+            }
+        }
+
+        template <class T>
+        void scale(size_t M, size_t N, T beta, T* C, size_t ldc)
+        {
+            for (size_t i = 0; i < M; i++)
+            {
+                T* c_row = C + i * ldc;
+                for (size_t j = 0; j < N; j++)
+                {
+                    c_row[j] = beta == 0 ? T(0) : beta * c_row[j];
+                }
+            }
+        }
+
+        // Unpacked path for tiny problems, where packing would cost more than
+        // it saves. The loop order is picked so the innermost loop walks
+        // memory with unit stride for whichever operands allow it.
+        template <class T>
+        void gemm_small(size_t M, size_t N, size_t K, T alpha,
+                        const Operand<T>& A, const Operand<T>& B,
+                        T beta, T* C, size_t ldc,
+                        const Epilogue<T>& ep)
+        {
+            if (N == 1 && A.cs == 1)
+            {
+                // Row dot products
+                for (size_t i = 0; i < M; i++)
+                {
+                    T sum = 0.0;
+                    for (size_t k = 0; k < K; k++)
+                    {
+                        sum += A(i, k) * B(k, 0);
+                    }
+                    C[i * ldc] = alpha * sum + (beta == 0 ? T(0) : beta * C[i * ldc]);
+                }
+                if (!ep.empty()) epilogue_rows(M, N, ep, C, ldc);
+                return;
+            }
+
+            scale(M, N, beta, C, ldc);
+
+            if (N == 1)
+            {
+                // Matrix-vector with op(A) = A^T: C += B(k, 0) * (row k of the stored A)
+                for (size_t k = 0; k < K; k++)
+                {
+                    const T b = alpha * B(k, 0);
+                    const T* a_row = A.p + k * A.cs;
+                    for (size_t i = 0; i < M; i++)
+                    {
+                        C[i * ldc] += b * a_row[i];
+                    }
+                }
+            }
+            else if (B.cs == 1)
+            {
+                // C row i += A(i, k) * B row k
+                for (size_t i = 0; i < M; i++)
+                {
+                    T* c_row = C + i * ldc;
+                    for (size_t k = 0; k < K; k++)
+                    {
+                        const T a = alpha * A(i, k);
+                        const T* b_row = B.p + k * B.rs;
+                        for (size_t j = 0; j < N; j++)
+                        {
+                            c_row[j] += a * b_row[j];
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // op(B) = B^T: each C element is a dot product along k
+                for (size_t i = 0; i < M; i++)
+                {
+                    for (size_t j = 0; j < N; j++)
+                    {
+                        T sum = 0.0;
+                        for (size_t k = 0; k < K; k++)
+                        {
+                            sum += A(i, k) * B(k, j);
+                        }
+                        C[i * ldc + j] += alpha * sum;
+                    }
+                }
+            }
+
+            // The whole of C is small enough to still be in cache
+            if (!ep.empty()) epilogue_rows(M, N, ep, C, ldc);
+        }
+
+        template <class T>
+        void gemm_impl(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                       T alpha, const T* A, size_t lda,
+                       const T* B, size_t ldb,
+                       T beta, T* C, size_t ldc,
+                       const Epilogue<T>& ep)
+        {
+            if (M == 0 || N == 0) return;
+
+            if (K == 0 || alpha == 0.0)
+            {
+                scale(M, N, beta, C, ldc);
+                if (!ep.empty()) epilogue_rows(M, N, ep, C, ldc);
+                return;
+            }
+
+            const Operand<T> a(A, lda, trans_a);
+            const Operand<T> b(B, ldb, trans_b);
+
+            const Tile<T> shape = tile<T>();
+
+            if (M * N * K < SMALL_THRESHOLD || M < shape.mr || N < shape.nr)
+            {
+                gemm_small(M, N, K, alpha, a, b, beta, C, ldc, ep);
+                return;
+            }
+
+            static thread_local std::vector<T, AlignedAllocator<T>> A_pack;
+            static thread_local std::vector<T, AlignedAllocator<T>> B_pack;
+
+            // MC and NC rounded up to whole micro-panels
+            const size_t mc_step = (MC + shape.mr - 1) / shape.mr * shape.mr;
+            const size_t nc_step = (NC + shape.nr - 1) / shape.nr * shape.nr;
+            const size_t mc_max = std::min(mc_step, (M + shape.mr - 1) / shape.mr * shape.mr);
+            const size_t nc_max = std::min(nc_step, (N + shape.nr - 1) / shape.nr * shape.nr);
+            const size_t kc_max = std::min(KC, K);
+
+            if (A_pack.size() < mc_max * kc_max) A_pack.resize(mc_max * kc_max);
+            if (B_pack.size() < kc_max * nc_max) B_pack.resize(kc_max * nc_max);
+
+            for (size_t jc = 0; jc < N; jc += nc_step)
+            {
+                const size_t nc = std::min(nc_step, N - jc);
+
+                for (size_t pc = 0; pc < K; pc += KC)
+                {
+                    const size_t kc = std::min(KC, K - pc);
+                    const T beta_block = pc == 0 ? beta : T(1);
+                    const bool last = pc + kc == K && !ep.empty();
+
+                    pack_B(kc, nc, shape.nr, b.offset(pc, jc), B_pack.data());
+
+                    for (size_t ic = 0; ic < M; ic += mc_step)
+                    {
+                        const size_t mc = std::min(mc_step, M - ic);
+
+                        const Epilogue<T> block = ep.offset(ic, jc);
+
+                        pack_A(mc, kc, shape.mr, alpha, a.offset(ic, pc), A_pack.data());
+                        macro_kernel(shape, mc, nc, kc, A_pack.data(), B_pack.data(),
+                                     beta_block, C + ic * ldc + jc, ldc, last ? &block : nullptr);
+                    }
+                }
+            }
+        }
+
+        // Splits C into a grid of tiles, at most one per thread, each large
+        // enough to stay on the packed path, and runs them on the pool.
+        template <class T>
+        void gemm_parallel(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                           T alpha, const T* A, size_t lda,
+                           const T* B, size_t ldb,
+                           T beta, T* C, size_t ldc,
+                           const Epilogue<T>& ep)
+        {
+            ThreadPool* pool = M * N * K >= PARALLEL_THRESHOLD ? &ThreadPool::global() : nullptr;
+            const size_t threads = pool ? pool->size() : 1;
+            const Tile<T> shape = tile<T>();
+
+            if (threads == 1)
+            {
+                gemm_impl(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, ep);
+                return;
+            }
+
+            // Grow the grid along whichever side has the larger tiles
+            size_t m_tiles = 1, n_tiles = 1;
+            while (m_tiles * n_tiles < threads)
+            {
+                const size_t tile_m = M / (m_tiles + 1);
+                const size_t tile_n = N / (n_tiles + 1);
+                const bool split_m = M / m_tiles >= N / n_tiles;
+
+                if (split_m && tile_m >= shape.mr && tile_m * (N / n_tiles) * K >= SMALL_THRESHOLD) m_tiles++;
+                else if (tile_n >= shape.nr && (M / m_tiles) * tile_n * K >= SMALL_THRESHOLD) n_tiles++;
+                else if (tile_m >= shape.mr && tile_m * (N / n_tiles) * K >= SMALL_THRESHOLD) m_tiles++;
+                else break;
+            }
+
+            // Tile edges on register-tile boundaries
+            const size_t tile_m = (M / m_tiles + shape.mr - 1) / shape.mr * shape.mr;
+            const size_t tile_n = (N / n_tiles + shape.nr - 1) / shape.nr * shape.nr;
+            m_tiles = (M + tile_m - 1) / tile_m;
+            n_tiles = (N + tile_n - 1) / tile_n;
+
+            pool->parallel_for(m_tiles * n_tiles, [&](size_t t)
+            {
+                const size_t i0 = (t / n_tiles) * tile_m;
+                const size_t j0 = (t % n_tiles) * tile_n;
+                const size_t mt = std::min(tile_m, M - i0);
+                const size_t nt = std::min(tile_n, N - j0);
+
+                const T* a = A + (trans_a == Trans::No ? i0 * lda : i0);
+                const T* b = B + (trans_b == Trans::No ? j0 : j0 * ldb);
+
+                gemm_impl(trans_a, trans_b, mt, nt, K, alpha, a, lda, b, ldb, beta, C + i0 * ldc + j0, ldc,
+                          ep.offset(i0, j0));
+            });
+        }
+
+        template <class T>
+        void gemm_reference_impl(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                                 T alpha, const T* A, size_t lda,
+                                 const T* B, size_t ldb,
+                                 T beta, T* C, size_t ldc)
+        {
+            const Operand<T> a(A, lda, trans_a);
+            const Operand<T> b(B, ldb, trans_b);
+
+            for (size_t i = 0; i < M; i++)
+            {
+                for (size_t j = 0; j < N; j++)
+                {
+                    T sum = 0.0;
+                    for (size_t k = 0; k < K; k++)
+                    {
+                        sum += a(i, k) * b(k, j);
+                    }
+                    C[i * ldc + j] = alpha * sum + (beta == 0 ? T(0) : beta * C[i * ldc + j]);
+                }
+            }
+        }
+    }
+
+    void set_num_threads(size_t threads) { ThreadPool::global().resize(threads); }
+    size_t num_threads() { return ThreadPool::global().size(); }
+
+    void gemm(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+              float alpha, const float* A, size_t lda,
+              const float* B, size_t ldb,
+              float beta, float* C, size_t ldc,
+              const Epilogue<float>& epilogue)
+    {
+        gemm_parallel(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+    }
+
+    void gemm(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+              double alpha, const double* A, size_t lda,
+              const double* B, size_t ldb,
+              double beta, double* C, size_t ldc,
+              const Epilogue<double>& epilogue)
+    {
+        gemm_parallel(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, epilogue);
+    }
+
+    void apply_epilogue(size_t M, size_t N, const Epilogue<float>& epilogue, float* C, size_t ldc)
+    {
+        epilogue_rows(M, N, epilogue, C, ldc);
+    }
+
+    void apply_epilogue(size_t M, size_t N, const Epilogue<double>& epilogue, double* C, size_t ldc)
+    {
+        epilogue_rows(M, N, epilogue, C, ldc);
+    }
+
+    void gemm_reference(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                        float alpha, const float* A, size_t lda,
+                        const float* B, size_t ldb,
+                        float beta, float* C, size_t ldc)
+    {
+        gemm_reference_impl(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+
+    void gemm_reference(Trans trans_a, Trans trans_b, size_t M, size_t N, size_t K,
+                        double alpha, const double* A, size_t lda,
+                        const double* B, size_t ldb,
+                        double beta, double* C, size_t ldc)
+    {
+        gemm_reference_impl(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    }
+}
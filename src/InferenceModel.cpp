@@ -0,0 +1,73 @@
+// inferencemodel.cpp
+
+#include "InferenceModel.hpp"
+#include "Network.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+InferenceModel::InferenceModel(std::vector<ModelIO::LayerShape> layers)
+    : shapes(std::move(layers)), params(nullptr), count(0)
+{
+    if (shapes.empty())
+    {
+        throw std::invalid_argument("Error: Inference model needs at least one layer");
+    }
+
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        if (i > 0 && shapes[i].input_size != shapes[i - 1].output_size)
+        {
+            throw std::invalid_argument(
+                "Error: Layer " + std::to_string(i) + " takes " + std::to_string(shapes[i].input_size) +
+                " inputs, the layer before it gives " + std::to_string(shapes[i - 1].output_size)
+            );
+        }
+        count += (shapes[i].input_size + 1) * shapes[i].output_size;
+    }
+
+    memory = Arena(Arena::footprint(count));
+    params = memory.allocate(count);
+    std::fill(params, params + count, Scalar(0));
+}
+
+static std::vector<ModelIO::LayerShape> network_shapes(const Network& network)
+{
+    std::vector<ModelIO::LayerShape> shapes;
+    for (const Layer& layer : network.get_layers())
+    {
+        shapes.push_back({ layer.get_input_size(), layer.get_output_size(), layer.get_activation() });
+    }
+    return shapes;
+}
+
+InferenceModel::InferenceModel(const Network& network)
+    : InferenceModel(network_shapes(network))
+{
+    const Scalar* source = network.get_parameters().parameters();
+    std::copy(source, source + count, params);
+}
+
+InferenceModel InferenceModel::load(const std::string& filepath)
+{
+    return ModelIO::load_inference(filepath);
+}
+
+std::vector<InferenceSession::LayerWeights> InferenceModel::weights() const
+{
+    std::vector<InferenceSession::LayerWeights> layers;
+
+    const Scalar* p = params;
+    for (const ModelIO::LayerShape& shape : shapes)
+    {
+        const size_t w_size = shape.output_size * shape.input_size;
+        layers.push_back({
+            ConstMatrixView(p, shape.output_size, shape.input_size),
+            ConstMatrixView(p + w_size, shape.output_size, 1),
+            shape.activation
+        });
+        p += w_size + shape.output_size;
+    }
+
+    return layers;
+}
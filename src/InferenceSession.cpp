@@ -0,0 +1,123 @@
+// inferencesession.cpp
+
+#include "InferenceSession.hpp"
+#include "InferenceModel.hpp"
+#include "Network.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static std::vector<InferenceSession::LayerWeights> shared_weights(const Network& network)
+{
+    std::vector<InferenceSession::LayerWeights> weights;
+    for (const Layer& layer : network.get_layers())
+    {
+        weights.push_back({ layer.getW(), layer.getb(), layer.get_activation() });
+    }
+    return weights;
+}
+
+InferenceSession::InferenceSession(const Network& network, size_t capacity)
+    : InferenceSession(shared_weights(network), capacity) {}
+
+InferenceSession::InferenceSession(const InferenceModel& model, size_t capacity)
+    : InferenceSession(model.weights(), capacity) {}
+
+InferenceSession::InferenceSession(std::vector<LayerWeights> layers_param, size_t capacity)
+    : layers(std::move(layers_param)), width(0), buffers{ nullptr, nullptr }, capacity(0)
+{
+    if (layers.empty())
+    {
+        throw std::invalid_argument("Error: Inference session needs at least one layer");
+    }
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (i > 0 && layers[i].W.cols() != layers[i - 1].W.rows())
+        {
+            throw std::invalid_argument(
+                "Error: Layer " + std::to_string(i) + " takes " + std::to_string(layers[i].W.cols()) +
+                " inputs, the layer before it gives " + std::to_string(layers[i - 1].W.rows())
+            );
+        }
+        width = std::max(width, layers[i].W.rows());
+    }
+
+    plan(std::max<size_t>(capacity, 1));
+}
+
+void InferenceSession::plan(size_t new_capacity)
+{
+    const size_t count = width * new_capacity;
+
+    Arena next(2 * Arena::footprint(count));
+    buffers[0] = next.allocate(count);
+    buffers[1] = next.allocate(count);
+
+    arena = std::move(next);
+    capacity = new_capacity;
+}
+
+ConstMatrixView InferenceSession::forward(ConstMatrixView input)
+{
+    if (input.rows() != input_size())
+    {
+        throw std::invalid_argument(
+            "Error: Input has " + std::to_string(input.rows()) + " features, the network expects " +
+            std::to_string(input_size())
+        );
+    }
+
+    const size_t batch = input.cols();
+    if (batch > capacity) plan(batch);
+
+    ConstMatrixView x = input;
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        const LayerWeights& layer = layers[i];
+        MatrixView y(buffers[i % 2], layer.W.rows(), batch);
+
+        // Activations are applied in place, over the product they follow
+        switch (layer.activation)
+        {
+            case Activation::RELU:
+                Matrix::affine_into(y, layer.W, x, layer.b, y, gemm::Activation::Relu);
+                break;
+            case Activation::SOFTMAX:
+                Matrix::affine_into(y, layer.W, x, layer.b);
+                Matrix::softmax_into(y, y);
+                break;
+            case Activation::LINEAR:
+            case Activation::SIGMOID:
+                Matrix::affine_into(y, layer.W, x, layer.b);
+                break;
+        }
+
+        x = y;
+    }
+
+    return x;
+}
+
+size_t InferenceSession::predict(ConstMatrixView input)
+{
+    size_t label;
+    predict(input.block(0, 0, input.rows(), 1), &label);
+    return label;
+}
+
+void InferenceSession::predict(ConstMatrixView input, size_t* labels)
+{
+    const ConstMatrixView output = forward(input);
+
+    for (size_t j = 0; j < output.cols(); j++)
+    {
+        size_t best = 0;
+        for (size_t i = 1; i < output.rows(); i++)
+        {
+            if (output.get(i, j) > output.get(best, j)) best = i;
+        }
+        labels[j] = best;
+    }
+}
@@ -0,0 +1,133 @@
+// kernels.cpp
+
+#include "Kernels.hpp"
+#include "SimdKernels.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace kernels
+{
+    namespace
+    {
+        // One-lane "vector" so the scalar fallback runs the same algorithms
+        // (including the polynomial exp) as the SIMD tables.
+        struct Generic
+        {
+            using V = Scalar;
+            static constexpr size_t W = 1;
+
+            static V load(const Scalar* p) { return *p; }
+            static void store(Scalar* p, V v) { *p = v; }
+            static V set1(Scalar x) { return x; }
+
+            static V add(V a, V b) { return a + b; }
+            static V sub(V a, V b) { return a - b; }
+            static V mul(V a, V b) { return a * b; }
+            static V div(V a, V b) { return a / b; }
+            static V sqrt(V a) { return std::sqrt(a); }
+            static V max(V a, V b) { return a > b ? a : b; }
+            static V min(V a, V b) { return a < b ? a : b; }
+            static V fmadd(V a, V b, V c) { return a * b + c; }
+
+            static V round(V x) { return std::nearbyint(x); }
+            static V step(V x) { return x > 0 ? 1 : 0; }
+
+            static V pow2n(V n)
+            {
+                // Only reached with NaN from a NaN input; converting it to an integer is undefined
+                if (n != n) return n;
+
+                if (sizeof(Scalar) == sizeof(float))
+                {
+                    const uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23;
+                    float result;
+                    std::memcpy(&result, &bits, sizeof(result));
+                    return result;
+                }
+
+                const uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(n) + 1023) << 52;
+                double result;
+                std::memcpy(&result, &bits, sizeof(result));
+                return result;
+            }
+
+            static Scalar hsum(V v) { return v; }
+            static Scalar hmax(V v) { return v; }
+        };
+
+        struct GenericS8
+        {
+            struct A { int32_t v[QUANT_BLOCK]; };
+            static constexpr size_t NR = 1;
+
+            static A zero() { return A{}; }
+
+            static A dot(A acc, int32_t x4, const int8_t* w)
+            {
+                int8_t x[4];
+                std::memcpy(x, &x4, sizeof(x));
+
+                for (size_t r = 0; r < QUANT_BLOCK; r++, w += 4)
+                {
+                    acc.v[r] += x[0] * w[0] + x[1] * w[1] + x[2] * w[2] + x[3] * w[3];
+                }
+                return acc;
+            }
+
+            static void finish(const A& acc, const QuantEpilogue& e, size_t i, size_t j, size_t rows)
+            {
+                finish_lanes(acc.v, 0, e, i, j, rows);
+            }
+        };
+
+        const KernelTable* find_table(const std::string& name)
+        {
+            if (name == "scalar") return &scalar::table();
+#if defined(__x86_64__) || defined(_M_X64)
+            if (name == "sse2") return &sse2::table();
+            if (name == "avx2" && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return &avx2::table();
+            if (name == "avx512" && __builtin_cpu_supports("avx512f")) return &avx512::table();
+            if (name == "avx512vnni" && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni"))
+            {
+                return &avx512vnni::table();
+            }
+#endif
+            return nullptr;
+        }
+
+        const KernelTable& select()
+        {
+#if defined(__x86_64__) || defined(_M_X64)
+            __builtin_cpu_init();
+#endif
+            if (const char* forced = std::getenv("CRNN_ISA"))
+            {
+                if (const KernelTable* table = find_table(forced)) return *table;
+            }
+
+#if defined(__x86_64__) || defined(_M_X64)
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni")) return avx512vnni::table();
+            if (__builtin_cpu_supports("avx512f")) return avx512::table();
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return avx2::table();
+            return sse2::table();
+#else
+            return scalar::table();
+#endif
+        }
+    }
+
+    const KernelTable& scalar::table()
+    {
+        static const KernelTable table = make_table<Generic, 4, 8>("scalar", &gemm_s8<GenericS8>);
+        return table;
+    }
+
+    const KernelTable& active()
+    {
+        static const KernelTable& table = select();
+        return table;
+    }
+}
@@ -0,0 +1,180 @@
+// kernelsavx2.cpp
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#if !defined(__AVX2__) || !defined(__FMA__)
+#error "KernelsAvx2.cpp must be compiled with -mavx2 -mfma"
+#endif
+
+#include "SimdKernels.hpp"
+#include <immintrin.h>
+
+namespace kernels
+{
+    namespace
+    {
+        template <class T> struct Avx2;
+
+        template <> struct Avx2<double>
+        {
+            using V = __m256d;
+            static constexpr size_t W = 4;
+
+            static V load(const double* p) { return _mm256_loadu_pd(p); }
+            static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+            static V set1(double x) { return _mm256_set1_pd(x); }
+
+            static V add(V a, V b) { return _mm256_add_pd(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+            static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+            static V div(V a, V b) { return _mm256_div_pd(a, b); }
+            static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+            static V max(V a, V b) { return _mm256_max_pd(a, b); }
+            static V min(V a, V b) { return _mm256_min_pd(a, b); }
+            static V fmadd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+
+            static V round(V x) { return _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static V step(V x)
+            {
+                return _mm256_and_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ), _mm256_set1_pd(1.0));
+            }
+
+            static V pow2n(V n)
+            {
+                const V biased = _mm256_add_pd(n, _mm256_set1_pd(1023.0 + 6755399441055744.0));
+                return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(biased), 52));
+            }
+
+            static double hsum(V v)
+            {
+                const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+                return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+            }
+
+            static double hmax(V v)
+            {
+                const __m128d m = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+                return _mm_cvtsd_f64(_mm_max_sd(m, _mm_unpackhi_pd(m, m)));
+            }
+        };
+
+        template <> struct Avx2<float>
+        {
+            using V = __m256;
+            static constexpr size_t W = 8;
+
+            static V load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+            static V set1(float x) { return _mm256_set1_ps(x); }
+
+            static V add(V a, V b) { return _mm256_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+            static V div(V a, V b) { return _mm256_div_ps(a, b); }
+            static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+            static V max(V a, V b) { return _mm256_max_ps(a, b); }
+            static V min(V a, V b) { return _mm256_min_ps(a, b); }
+            static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+
+            static V round(V x) { return _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static V step(V x)
+            {
+                return _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+            }
+
+            static V pow2n(V n)
+            {
+                const V biased = _mm256_add_ps(n, _mm256_set1_ps(127.0f + 12582912.0f));
+                return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(biased), 23));
+            }
+
+            static float hsum(V v)
+            {
+                __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+                return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+            }
+
+            static float hmax(V v)
+            {
+                __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+                return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+            }
+        };
+
+        // Each 16 bytes of a packed group (four channels) are sign-extended
+        // to 16 bits and multiplied by the activations in pairs (madd, which
+        // cannot saturate, unlike maddubs). The two partial sums per channel
+        // are added once, in the epilogue.
+        struct Avx2S8
+        {
+            struct A { __m256i v[QUANT_BLOCK / 4]; };
+            static constexpr size_t NR = 2;
+
+            static A zero()
+            {
+                A acc;
+                for (__m256i& v : acc.v) v = _mm256_setzero_si256();
+                return acc;
+            }
+
+            static A dot(A acc, int32_t x4, const int8_t* w)
+            {
+                const __m256i x = _mm256_cvtepi8_epi16(_mm_set1_epi32(x4));
+
+                for (size_t c = 0; c < QUANT_BLOCK / 4; c++)
+                {
+                    const __m256i wv = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + 16 * c)));
+                    acc.v[c] = _mm256_add_epi32(acc.v[c], _mm256_madd_epi16(x, wv));
+                }
+                return acc;
+            }
+
+            // Eight channels' sums, scaled, biased and rectified
+            static __m256 dequantize(__m256i lo, __m256i hi, const QuantEpilogue& e, size_t i)
+            {
+                // hadd leaves channels in the order 0 1 4 5 2 3 6 7
+                const __m256i sums = _mm256_permutevar8x32_epi32(
+                    _mm256_hadd_epi32(lo, hi), _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7)
+                );
+
+                __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(sums), _mm256_loadu_ps(e.scale + i));
+                v = _mm256_add_ps(v, _mm256_loadu_ps(e.bias + i));
+                return e.relu ? _mm256_max_ps(v, _mm256_setzero_ps()) : v;
+            }
+
+            static void finish(const A& acc, const QuantEpilogue& e, size_t i, size_t j, size_t rows)
+            {
+                const __m256 v0 = dequantize(acc.v[0], acc.v[1], e, i);
+                const __m256 v1 = dequantize(acc.v[2], acc.v[3], e, i + 8);
+
+                if (!e.qout)
+                {
+                    float v[QUANT_BLOCK];
+                    _mm256_storeu_ps(v, v0);
+                    _mm256_storeu_ps(v + 8, v1);
+                    store_s8(v, e, i, j, rows);
+                    return;
+                }
+
+                const __m256 lo = _mm256_set1_ps(-127.0f), hi = _mm256_set1_ps(127.0f);
+                const __m256i q0 = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v0, lo), hi));
+                const __m256i q1 = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v1, lo), hi));
+
+                // packs works within 128-bit halves; the permute restores order
+                const __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(q0, q1), 0xD8);
+                const __m128i bytes = _mm_packs_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(e.qout + j * e.ldq + i), bytes);
+            }
+        };
+    }
+
+    const KernelTable& avx2::table()
+    {
+        static const KernelTable table = make_table<Avx2<Scalar>, 6, 2>("avx2", &gemm_s8<Avx2S8>);
+        return table;
+    }
+}
+
+#endif
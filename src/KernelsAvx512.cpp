@@ -0,0 +1,103 @@
+// kernelsavx512.cpp
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#if !defined(__AVX512F__)
+#error "KernelsAvx512.cpp must be compiled with -mavx512f"
+#endif
+
+#include "SimdKernels.hpp"
+#include <immintrin.h>
+
+namespace kernels
+{
+    namespace
+    {
+        template <class T> struct Avx512;
+
+        template <> struct Avx512<double>
+        {
+            using V = __m512d;
+            static constexpr size_t W = 8;
+
+            static V load(const double* p) { return _mm512_loadu_pd(p); }
+            static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+            static V set1(double x) { return _mm512_set1_pd(x); }
+
+            static V add(V a, V b) { return _mm512_add_pd(a, b); }
+            static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+            static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+            static V div(V a, V b) { return _mm512_div_pd(a, b); }
+            static V sqrt(V a) { return _mm512_sqrt_pd(a); }
+            static V max(V a, V b) { return _mm512_max_pd(a, b); }
+            static V min(V a, V b) { return _mm512_min_pd(a, b); }
+            static V fmadd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+
+            static V round(V x) { return _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static V step(V x)
+            {
+                return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ), _mm512_set1_pd(1.0));
+            }
+
+            static V pow2n(V n)
+            {
+                const V biased = _mm512_add_pd(n, _mm512_set1_pd(1023.0 + 6755399441055744.0));
+                return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(biased), 52));
+            }
+
+            static double hsum(V v) { return _mm512_reduce_add_pd(v); }
+            static double hmax(V v) { return _mm512_reduce_max_pd(v); }
+        };
+
+        template <> struct Avx512<float>
+        {
+            using V = __m512;
+            static constexpr size_t W = 16;
+
+            static V load(const float* p) { return _mm512_loadu_ps(p); }
+            static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+            static V set1(float x) { return _mm512_set1_ps(x); }
+
+            static V add(V a, V b) { return _mm512_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+            static V div(V a, V b) { return _mm512_div_ps(a, b); }
+            static V sqrt(V a) { return _mm512_sqrt_ps(a); }
+            static V max(V a, V b) { return _mm512_max_ps(a, b); }
+            static V min(V a, V b) { return _mm512_min_ps(a, b); }
+            static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+
+            static V round(V x) { return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static V step(V x)
+            {
+                return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ), _mm512_set1_ps(1.0f));
+            }
+
+            static V pow2n(V n)
+            {
+                const V biased = _mm512_add_ps(n, _mm512_set1_ps(127.0f + 12582912.0f));
+                return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_castps_si512(biased), 23));
+            }
+
+            static float hsum(V v) { return _mm512_reduce_add_ps(v); }
+            static float hmax(V v) { return _mm512_reduce_max_ps(v); }
+        };
+
+    }
+
+    const KernelTable& avx512::table()
+    {
+        // Byte and word arithmetic on 512-bit registers needs AVX512BW, so
+        // without VNNI the int8 product is the AVX2 one
+        static const KernelTable table = make_table<Avx512<Scalar>, 8, 3>("avx512", avx2::table().gemm_s8);
+        return table;
+    }
+
+    const KernelTable& avx512vnni::table()
+    {
+        static const KernelTable table = make_table<Avx512<Scalar>, 8, 3>("avx512vnni", &avx512vnni::gemm_s8);
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+// kernelssse2.cpp
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include "SimdKernels.hpp"
+#include <emmintrin.h>
+
+namespace kernels
+{
+    namespace
+    {
+        template <class T> struct Sse2;
+
+        template <> struct Sse2<double>
+        {
+            using V = __m128d;
+            static constexpr size_t W = 2;
+
+            static V load(const double* p) { return _mm_loadu_pd(p); }
+            static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+            static V set1(double x) { return _mm_set1_pd(x); }
+
+            static V add(V a, V b) { return _mm_add_pd(a, b); }
+            static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+            static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+            static V div(V a, V b) { return _mm_div_pd(a, b); }
+            static V sqrt(V a) { return _mm_sqrt_pd(a); }
+            static V max(V a, V b) { return _mm_max_pd(a, b); }
+            static V min(V a, V b) { return _mm_min_pd(a, b); }
+            static V fmadd(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+            static V round(V x) { return _mm_cvtepi32_pd(_mm_cvtpd_epi32(x)); }
+            static V step(V x) { return _mm_and_pd(_mm_cmpgt_pd(x, _mm_setzero_pd()), _mm_set1_pd(1.0)); }
+
+            // Adding 1.5 * 2^52 leaves n + 1023 in the low mantissa bits;
+            // shifting them into the exponent field yields 2^n.
+            static V pow2n(V n)
+            {
+                const V biased = _mm_add_pd(n, _mm_set1_pd(1023.0 + 6755399441055744.0));
+                return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(biased), 52));
+            }
+
+            static double hsum(V v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+            static double hmax(V v) { return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v))); }
+        };
+
+        template <> struct Sse2<float>
+        {
+            using V = __m128;
+            static constexpr size_t W = 4;
+
+            static V load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+            static V set1(float x) { return _mm_set1_ps(x); }
+
+            static V add(V a, V b) { return _mm_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+            static V div(V a, V b) { return _mm_div_ps(a, b); }
+            static V sqrt(V a) { return _mm_sqrt_ps(a); }
+            static V max(V a, V b) { return _mm_max_ps(a, b); }
+            static V min(V a, V b) { return _mm_min_ps(a, b); }
+            static V fmadd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+            static V round(V x) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(x)); }
+            static V step(V x) { return _mm_and_ps(_mm_cmpgt_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+
+            static V pow2n(V n)
+            {
+                const V biased = _mm_add_ps(n, _mm_set1_ps(127.0f + 12582912.0f));
+                return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(biased), 23));
+            }
+
+            static float hsum(V v)
+            {
+                const V s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+                return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+            }
+
+            static float hmax(V v)
+            {
+                const V m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+                return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+            }
+        };
+
+        // Each 16 bytes of a packed group (four channels) are sign-extended
+        // to 16 bits and multiplied by the activations in pairs, leaving two
+        // partial sums per channel, added up in the epilogue
+        struct Sse2S8
+        {
+            struct A { __m128i v[QUANT_BLOCK / 2]; };
+            static constexpr size_t NR = 1;
+
+            static __m128i widen_lo(__m128i v) { return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8); }
+            static __m128i widen_hi(__m128i v) { return _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8); }
+
+            static A zero()
+            {
+                A acc;
+                for (__m128i& v : acc.v) v = _mm_setzero_si128();
+                return acc;
+            }
+
+            static A dot(A acc, int32_t x4, const int8_t* w)
+            {
+                const __m128i x = widen_lo(_mm_cvtsi32_si128(x4));
+                const __m128i xx = _mm_unpacklo_epi64(x, x);
+
+                for (size_t c = 0; c < QUANT_BLOCK / 4; c++)
+                {
+                    const __m128i wv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + 16 * c));
+                    acc.v[2 * c] = _mm_add_epi32(acc.v[2 * c], _mm_madd_epi16(xx, widen_lo(wv)));
+                    acc.v[2 * c + 1] = _mm_add_epi32(acc.v[2 * c + 1], _mm_madd_epi16(xx, widen_hi(wv)));
+                }
+                return acc;
+            }
+
+            static void finish(const A& acc, const QuantEpilogue& e, size_t i, size_t j, size_t rows)
+            {
+                int32_t partial[2 * QUANT_BLOCK];
+                for (size_t c = 0; c < QUANT_BLOCK / 2; c++)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(partial + 4 * c), acc.v[c]);
+                }
+
+                int32_t sums[QUANT_BLOCK];
+                for (size_t r = 0; r < QUANT_BLOCK; r++) sums[r] = partial[2 * r] + partial[2 * r + 1];
+                finish_lanes(sums, 0, e, i, j, rows);
+            }
+        };
+    }
+
+    const KernelTable& sse2::table()
+    {
+        static const KernelTable table = make_table<Sse2<Scalar>, 6, 2>("sse2", &gemm_s8<Sse2S8>);
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,64 @@
+// kernelsvnni.cpp
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#if !defined(__AVX512F__) || !defined(__AVX512VNNI__)
+#error "KernelsVnni.cpp must be compiled with -mavx512f -mavx512vnni"
+#endif
+
+#include "SimdKernels.hpp"
+#include <immintrin.h>
+
+namespace kernels
+{
+    namespace
+    {
+        // One vpdpbusd multiplies a whole packed group (sixteen channels by
+        // four inputs) and adds each channel's four products into its lane.
+        // It takes unsigned activations: flipping the sign bit turns x into
+        // x + 128, and the extra 128 * (sum of the row) comes off in the
+        // epilogue.
+        struct VnniS8
+        {
+            using A = __m512i;
+            static constexpr size_t NR = 4;
+
+            static A zero() { return _mm512_setzero_si512(); }
+
+            static A dot(A acc, int32_t x4, const int8_t* w)
+            {
+                const __m512i x = _mm512_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(x4) ^ 0x80808080u));
+                return _mm512_dpbusd_epi32(acc, x, _mm512_loadu_si512(w));
+            }
+
+            static void finish(A acc, const QuantEpilogue& e, size_t i, size_t j, size_t rows)
+            {
+                const __m512i offset = _mm512_slli_epi32(_mm512_loadu_si512(e.row_sums + i), 7);
+
+                __m512 v = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(acc, offset)), _mm512_loadu_ps(e.scale + i));
+                v = _mm512_add_ps(v, _mm512_loadu_ps(e.bias + i));
+                if (e.relu) v = _mm512_max_ps(v, _mm512_setzero_ps());
+
+                if (!e.qout)
+                {
+                    float values[QUANT_BLOCK];
+                    _mm512_storeu_ps(values, v);
+                    store_s8(values, e, i, j, rows);
+                    return;
+                }
+
+                v = _mm512_min_ps(_mm512_max_ps(v, _mm512_set1_ps(-127.0f)), _mm512_set1_ps(127.0f));
+                const __m128i bytes = _mm512_cvtepi32_epi8(_mm512_cvtps_epi32(v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(e.qout + j * e.ldq + i), bytes);
+            }
+        };
+    }
+
+    void avx512vnni::gemm_s8(const int8_t* W, const int8_t* X, size_t ldx,
+                             size_t M, size_t N, size_t K, const QuantEpilogue& epilogue)
+    {
+        kernels::gemm_s8<VnniS8>(W, X, ldx, M, N, K, epilogue);
+    }
+}
+
+#endif
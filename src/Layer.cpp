@@ -10,6 +10,7 @@
 Layer::Layer(size_t input_size, size_t output_size, Activation activation) :
     input_size(input_size),
     output_size(output_size),
+    batch_capacity(1),
     activation(activation),
 
     A(output_size, 1),
@@ -22,9 +23,9 @@ Layer::Layer(size_t input_size, size_t output_size, Activation activation) :
     dW(output_size, input_size),
     dZ(output_size, 1),
 
-    vW(output_size, input_size),
     vb(output_size, 1),
-    prev_A(nullptr),
+    vW(output_size, input_size),
+    prev_A(),
     prev_dA(nullptr)
 { }
 
@@ -36,21 +37,73 @@ const Matrix& Layer::get_dA() const { return dA; }
 Matrix& Layer::getA() { return A; }
 Matrix& Layer::get_dA() { return dA; }
 
-void Layer::setA(const Matrix& g) { A = g; }
-void Layer::set_dA(const Matrix& g) { dA = g; }
+void Layer::setA(ConstMatrixView g) { A.copy_from(g); }
+void Layer::set_dA(ConstMatrixView g) { dA.copy_from(g); }
 
 const Matrix& Layer::get_dZ() const { return dZ; }
-void Layer::set_dZ(const Matrix& g) { dZ = g; }
+Matrix& Layer::get_dZ() { return dZ; }
+void Layer::set_dZ(ConstMatrixView g) { dZ.copy_from(g); }
+
+void Layer::set_prev_A(ConstMatrixView input) { prev_A = input; }
+
+// Parameters and workspace
+
+size_t Layer::parameter_count() const
+{
+    return W.rows() * W.cols() + b.rows() * b.cols();
+}
 
-void Layer::set_prev_A(const Matrix* prev_A_ptr) { prev_A = prev_A_ptr; }
+void Layer::bind_parameters(Scalar* params, Scalar* grads, Scalar* velocity)
+{
+    const size_t w_size = W.rows() * W.cols();
+
+    W.rebind(params);
+    b.rebind(params + w_size);
+    dW.rebind(grads);
+    db.rebind(grads + w_size);
+    vW.rebind(velocity);
+    vb.rebind(velocity + w_size);
+}
 
-void Layer::step(double lr, double beta)
+size_t Layer::workspace_size(size_t capacity) const
 {
-    vW = (vW * beta) + (dW * (1 - beta));
-    vb = (vb * beta) + (db * (1 - beta));
+    return 4 * Arena::footprint(output_size * capacity);
+}
 
-    W -= vW * lr;
-    b -= vb * lr;
+void Layer::bind(Arena& arena, size_t capacity)
+{
+    for (Matrix* m : { &A, &Z, &dA, &dZ })
+    {
+        m->rebind(arena.allocate(output_size * capacity), output_size, capacity);
+    }
+    batch_capacity = capacity;
+}
+
+void Layer::set_batch(size_t batch)
+{
+    if (batch == A.cols()) return;
+
+    if (batch == 0 || batch > batch_capacity)
+    {
+        throw std::invalid_argument(
+            "Error: Batch of " + std::to_string(batch) + " samples, layer has room for " +
+            std::to_string(batch_capacity)
+        );
+    }
+
+    // Narrower batches use the front of the same buffers
+    for (Matrix* m : { &A, &Z, &dA, &dZ })
+    {
+        m->rebind(m->data(), output_size, batch);
+    }
+}
+
+// Data-parallel replicas
+
+void Layer::share_parameters(Layer& source)
+{
+    W.rebind(source.W.data(), source.W.rows(), source.W.cols());
+    b.rebind(source.b.data(), source.b.rows(), source.b.cols());
 }
 
 // Connectors
@@ -66,7 +119,7 @@ void Layer::connect_prev(const Layer& prev)
         );
     }
 
-    prev_A = &prev.getA();
+    prev_A = prev.getA();
     prev_dA = const_cast<Matrix*>(&prev.get_dA());
 }
 
@@ -112,22 +165,24 @@ void Layer::init_weights(InitType init_type)
 
 void Layer::forward()
 {
-    Z = (W * (*prev_A)) + b;
-
+    // Z = W * prev_A + b, with the bias and the activation applied as
+    // each tile of the product is stored
     switch (activation)
     {
         case Activation::RELU:
-            A = Z.relu();
+            Matrix::affine_into(Z, W, prev_A, b, A, gemm::Activation::Relu);
             break;
         case Activation::SOFTMAX:
-            A = Z.softmax();
+            // Needs whole columns of Z, so it runs once the product is done
+            Matrix::affine_into(Z, W, prev_A, b);
+            Matrix::softmax_into(A, Z);
             break;
         case Activation::LINEAR:
-            A = Z;
+            Matrix::affine_into(Z, W, prev_A, b, A);
             break;
         case Activation::SIGMOID:
             // TODO: Implement sigmoid activation
-            A = Z;
+            Matrix::affine_into(Z, W, prev_A, b, A);
             break;
     }
 }
@@ -144,13 +199,7 @@ void Layer::backprop()
             break;
         case Activation::LINEAR:
             dZ = dA;
-            dW = dZ * prev_A->transpose();
-            db = dZ;
-            if (prev_dA != nullptr)
-            {
-                Matrix temp = W.transpose() * dZ;
-                *prev_dA = temp;
-            }
+            backprop_weights();
             break;
         case Activation::SIGMOID:
             // TODO
@@ -160,25 +209,26 @@ void Layer::backprop()
 
 void Layer::backprop_relu()
 {
-    dZ = dA.hadamard(Z.drelu());
-    dW = dZ * prev_A->transpose();
-    db = dZ;
-
-    if (prev_dA != nullptr)
-    {
-        Matrix temp = W.transpose() * dZ;
-        *prev_dA = temp;
-    }
+    Matrix::relu_backward_into(dZ, dA, Z);
+    backprop_weights();
 }
 
 void Layer::backprop_softmax()
 {
-    dW = dZ * prev_A->transpose();
-    db = dZ;
+    backprop_weights();
+}
+
+// dW and db averaged over the batch, and the previous layer's dA, from dZ
+
+void Layer::backprop_weights()
+{
+    const Scalar inv_batch = Scalar(1) / Scalar(dZ.cols());
+
+    Matrix::multiply_into(dW, dZ, gemm::Trans::No, prev_A, gemm::Trans::Yes, inv_batch);
+    Matrix::sum_cols_into(db, dZ, inv_batch);
 
     if (prev_dA != nullptr)
     {
-        Matrix temp = W.transpose() * dZ;
-        *prev_dA = temp;
+        Matrix::multiply_into(*prev_dA, W, gemm::Trans::Yes, dZ, gemm::Trans::No);
     }
-}
\ No newline at end of file
+}
@@ -1,95 +1,273 @@
 // matrix.cpp
 
 #include "Matrix.hpp"
+#include "Blas.hpp"
+#include "Gemm.hpp"
+#include "Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static void check_same_shape(ConstMatrixView a, ConstMatrixView b, const char* message)
+{
+    if (a.rows() != b.rows() || a.cols() != b.cols())
+    {
+        throw std::invalid_argument(message);
+    }
+}
 
-Matrix::Matrix() : row(0), col(0), data(0) {}
+static void check_destination(ConstMatrixView dst, size_t rows, size_t cols)
+{
+    if (dst.rows() != rows || dst.cols() != cols)
+    {
+        throw std::invalid_argument(
+            "Destination matrix is " + std::to_string(dst.rows()) + "x" + std::to_string(dst.cols()) +
+            ", expected " + std::to_string(rows) + "x" + std::to_string(cols)
+        );
+    }
+}
 
-Matrix::Matrix(size_t row, size_t col) : row(row), col(col), data(row * col) {}
+static bool overlaps(ConstMatrixView x, ConstMatrixView y)
+{
+    if (x.size() == 0 || y.size() == 0) return false;
 
-Matrix::Matrix(size_t row, size_t col, std::vector<double> data) : row(row), col(col), data(data) {}
+    const Scalar* x_end = x.row_data(x.rows() - 1) + x.cols();
+    const Scalar* y_end = y.row_data(y.rows() - 1) + y.cols();
+    return x.data() < y_end && y.data() < x_end;
+}
 
-double Matrix::get(size_t row, size_t col) const { return data[row * this->col + col]; }
-void Matrix::set(size_t row, size_t col, double value) { data[row * this->col + col] = value; }
+// Runs f(out, x, y, n) over matching views: once over the whole buffer
+// when all three are contiguous, otherwise once per row.
+template <class F>
+static void for_each_row(MatrixView dst, ConstMatrixView a, ConstMatrixView b, F f)
+{
+    if (dst.is_contiguous() && a.is_contiguous() && b.is_contiguous())
+    {
+        f(dst.data(), a.data(), b.data(), dst.size());
+        return;
+    }
 
-void Matrix::fill(double value) { std::fill(data.begin(), data.end(), value); }
+    for (size_t r = 0; r < dst.rows(); r++)
+    {
+        f(dst.row_data(r), a.row_data(r), b.row_data(r), dst.cols());
+    }
+}
+
+Matrix::Matrix() : row(0), col(0), values(nullptr) {}
+
+Matrix::Matrix(size_t row, size_t col) : row(row), col(col), storage(row * col), values(storage.data()) {}
+
+Matrix::Matrix(size_t row, size_t col, std::vector<Scalar> data)
+    : row(row), col(col), storage(data.begin(), data.end()), values(storage.data()) {}
+
+Matrix::Matrix(const Matrix& other)
+    : row(other.row), col(other.col),
+      storage(other.values, other.values + other.row * other.col),
+      values(storage.data()) {}
+
+Matrix::Matrix(Matrix&& other) noexcept
+    : row(other.row), col(other.col), storage(std::move(other.storage)), values(other.values)
+{
+    other.row = 0;
+    other.col = 0;
+    other.values = nullptr;
+}
+
+Matrix::Matrix(ConstMatrixView v) : row(v.rows()), col(v.cols()), storage(v.size()), values(storage.data())
+{
+    copy_from(v);
+}
+
+Matrix Matrix::view(Scalar* memory, size_t rows, size_t cols)
+{
+    Matrix m;
+    m.row = rows;
+    m.col = cols;
+    m.values = memory;
+    return m;
+}
+
+void Matrix::rebind(Scalar* memory)
+{
+    std::copy(values, values + row * col, memory);
+    values = memory;
+    std::vector<Scalar, AlignedAllocator<Scalar>>().swap(storage);
+}
+
+void Matrix::rebind(Scalar* memory, size_t rows, size_t cols)
+{
+    row = rows;
+    col = cols;
+    values = memory;
+    std::vector<Scalar, AlignedAllocator<Scalar>>().swap(storage);
+}
+
+Scalar Matrix::get(size_t row, size_t col) const { return values[row * this->col + col]; }
+void Matrix::set(size_t row, size_t col, Scalar value) { values[row * this->col + col] = value; }
+
+void Matrix::fill(Scalar value) { std::fill(values, values + row * col, value); }
+
+void Matrix::set_data(const std::vector<Scalar>& new_data)
+{
+    if (new_data.size() != row * col)
+    {
+        throw std::invalid_argument(
+            "Data has " + std::to_string(new_data.size()) + " elements, expected " + std::to_string(row * col)
+        );
+    }
+    std::copy(new_data.begin(), new_data.end(), values);
+}
+
+void Matrix::copy_from(ConstMatrixView v)
+{
+    check_destination(*this, v.rows(), v.cols());
+
+    for (size_t r = 0; r < row; r++)
+    {
+        std::copy(v.row_data(r), v.row_data(r) + col, values + r * col);
+    }
+}
 
 size_t Matrix::rows() const { return row; }
 size_t Matrix::cols() const { return col; }
 
+void Matrix::reshape(size_t rows, size_t cols)
+{
+    if (rows == row && cols == col) return;
+
+    if (is_view())
+    {
+        throw std::invalid_argument(
+            "Cannot reshape a " + std::to_string(row) + "x" + std::to_string(col) +
+            " matrix view to " + std::to_string(rows) + "x" + std::to_string(cols)
+        );
+    }
+
+    row = rows;
+    col = cols;
+    storage.resize(rows * cols);
+    values = storage.data();
+}
+
+// In-place operators
 
 Matrix& Matrix::operator+=(const Matrix& other) 
 {
-    *this = *this + other;
+    add_into(*this, *this, other);
     return *this;
 }
 
 Matrix& Matrix::operator-=(const Matrix& other) 
 {
-    *this = *this - other;
+    sub_into(*this, *this, other);
     return *this;
 }
 
-Matrix& Matrix::operator*=(double scalar) 
+Matrix& Matrix::operator*=(Scalar scalar) 
 {
-    *this = *this * scalar;
+    scale_into(*this, *this, scalar);
     return *this;
 }
 
 Matrix& Matrix::operator*=(const Matrix& other)
 {
+    // A product cannot be formed in place; this one still allocates.
     *this = *this * other;
     return *this;
 }
 
-Matrix Matrix::operator+(const Matrix& other) const
+Matrix& Matrix::add_scaled(const Matrix& other, Scalar alpha)
 {
-    if (row != other.row || col != other.col)
-    {
-        throw std::invalid_argument("Matrix dimensions must match for addition");
-    }
-    
-    Matrix result(row, col);
-    for (size_t i = 0; i < row * col; i++)
+    check_same_shape(*this, other, "Matrix dimensions must match for addition");
+    kernels::active().axpy(alpha, other.values, values, row * col);
+    return *this;
+}
+
+Matrix& Matrix::operator=(const Matrix& other)
+{
+    if (this == &other) return *this;
+
+    if (is_view())
     {
-        result.data[i] = data[i] + other.data[i];
+        check_destination(*this, other.row, other.col);
+        std::copy(other.values, other.values + row * col, values);
+        return *this;
     }
-    return result;
+
+    row = other.row;
+    col = other.col;
+    storage.assign(other.values, other.values + row * col);
+    values = storage.data();
+    return *this;
 }
 
-Matrix Matrix::operator-(const Matrix& other) const
+Matrix& Matrix::operator=(Matrix&& other)
 {
-    if (row != other.row || col != other.col)
+    if (this == &other) return *this;
+
+    if (is_view() || other.is_view())
     {
-        throw std::invalid_argument("Matrix dimensions must match for subtraction");
+        // Views cannot hand over or take ownership; copy the values
+        return *this = static_cast<const Matrix&>(other);
     }
-    
-    Matrix result(row, col);
-    for (size_t i = 0; i < row * col; i++)
+
+    row = other.row;
+    col = other.col;
+    storage = std::move(other.storage);
+    values = other.values;
+
+    other.row = 0;
+    other.col = 0;
+    other.values = nullptr;
+    return *this;
+}
+
+// Matrix products
+
+Matrix::Matrix(const expr::Product& p)
+    : row(p.rows()), col(p.cols()), storage(p.rows() * p.cols()), values(storage.data())
+{
+    p.evaluate_into(*this, 1.0, 0.0);
+}
+
+Matrix& Matrix::operator=(const expr::Product& p)
+{
+    if (p.aliases(*this))
     {
-        result.data[i] = data[i] - other.data[i];
+        Matrix result(p);
+        return *this = result;
     }
-    return result;
+
+    reshape(p.rows(), p.cols());
+    p.evaluate_into(*this, 1.0, 0.0);
+    return *this;
 }
 
-Matrix& Matrix::operator=(const Matrix& other)
+Matrix& Matrix::operator+=(const expr::Product& p)
 {
-    row = other.row;
-    col = other.col;
-    data = other.data;
+    if (p.aliases(*this))
+    {
+        Matrix result(p);
+        return *this += result;
+    }
+
+    p.evaluate_into(*this, 1.0, 1.0);
     return *this;
 }
 
-Matrix Matrix::operator*(double scalar) const
+Matrix& Matrix::operator-=(const expr::Product& p)
 {
-    Matrix result(row, col);
-    for (size_t i = 0; i < row * col; i++)
+    if (p.aliases(*this))
     {
-        result.data[i] = data[i] * scalar;
+        Matrix result(p);
+        return *this -= result;
     }
-    return result;
+
+    p.evaluate_into(*this, -1.0, 1.0);
+    return *this;
 }
 
-Matrix Matrix::operator*(const Matrix& other) const
+Matrix Matrix::multiply_reference(const Matrix& other) const
 {
     if (col != other.row)
     {
@@ -97,107 +275,242 @@ Matrix Matrix::operator*(const Matrix& other) const
     }
     
     Matrix result(row, other.col);
-    for (size_t i = 0; i < row; i++)
+    gemm::gemm_reference(gemm::Trans::No, gemm::Trans::No, row, other.col, col,
+                         1.0, values, col,
+                         other.values, other.col,
+                         0.0, result.values, other.col);
+    return result;
+}
+
+// Transposes
+
+Matrix::Matrix(const expr::Transposed& t)
+    : row(t.rows()), col(t.cols()), storage(t.rows() * t.cols()), values(storage.data())
+{
+    transpose_into(*this, t.m);
+}
+
+Matrix& Matrix::operator=(const expr::Transposed& t)
+{
+    if (&t.m == this)
     {
-        for (size_t j = 0; j < other.col; j++)
-        {
-            double sum = 0.0;
-            for (size_t k = 0; k < col; k++)
-            {
-                sum += data[i * col + k] * other.data[k * other.col + j];
-            }
-            result.data[i * other.col + j] = sum;
-        }
+        Matrix result(t);
+        return *this = result;
     }
-    return result;
+
+    reshape(t.rows(), t.cols());
+    transpose_into(*this, t.m);
+    return *this;
+}
+
+// Output-parameter variants
+
+void Matrix::add_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b)
+{
+    check_same_shape(a, b, "Matrix dimensions must match for addition");
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, a, b, [](Scalar* out, const Scalar* x, const Scalar* y, size_t n)
+    {
+        kernels::active().add(x, y, out, n);
+    });
+}
+
+void Matrix::sub_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b)
+{
+    check_same_shape(a, b, "Matrix dimensions must match for subtraction");
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, a, b, [](Scalar* out, const Scalar* x, const Scalar* y, size_t n)
+    {
+        kernels::active().sub(x, y, out, n);
+    });
+}
+
+void Matrix::scale_into(MatrixView dst, ConstMatrixView a, Scalar scalar)
+{
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, a, a, [scalar](Scalar* out, const Scalar* x, const Scalar*, size_t n)
+    {
+        kernels::active().scale(x, scalar, out, n);
+    });
+}
+
+void Matrix::hadamard_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b)
+{
+    check_same_shape(a, b, "Matrix dimensions must match for hadamard product");
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, a, b, [](Scalar* out, const Scalar* x, const Scalar* y, size_t n)
+    {
+        kernels::active().mul(x, y, out, n);
+    });
+}
+
+void Matrix::multiply_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b, Scalar alpha, Scalar beta)
+{
+    multiply_into(dst, a, gemm::Trans::No, b, gemm::Trans::No, alpha, beta);
 }
 
-Matrix Matrix::hadamard(const Matrix& other) const
+void Matrix::multiply_into(MatrixView dst, ConstMatrixView a, gemm::Trans trans_a,
+                           ConstMatrixView b, gemm::Trans trans_b,
+                           Scalar alpha, Scalar beta)
 {
-    Matrix result(row, col);
-    for (size_t i = 0; i < row * col; i++)
+    const size_t M = trans_a == gemm::Trans::No ? a.rows() : a.cols();
+    const size_t K = trans_a == gemm::Trans::No ? a.cols() : a.rows();
+    const size_t K_b = trans_b == gemm::Trans::No ? b.rows() : b.cols();
+    const size_t N = trans_b == gemm::Trans::No ? b.cols() : b.rows();
+
+    if (K != K_b)
     {
-        result.data[i] = data[i] * other.data[i];
+        throw std::invalid_argument("Matrix dimensions incompatible for multiplication");
     }
-    return result;
+    if (overlaps(dst, a) || overlaps(dst, b))
+    {
+        throw std::invalid_argument("Destination of a matrix product must not alias an operand");
+    }
+    check_destination(dst, M, N);
+
+    blas::gemm(trans_a, trans_b, M, N, K,
+               alpha, a.data(), a.stride(),
+               b.data(), b.stride(),
+               beta, dst.data(), dst.stride());
+}
+
+void Matrix::affine_into(MatrixView dst, ConstMatrixView a, ConstMatrixView b, ConstMatrixView bias,
+                         MatrixView activated, gemm::Activation activation)
+{
+    if (a.cols() != b.rows())
+    {
+        throw std::invalid_argument("Matrix dimensions incompatible for multiplication");
+    }
+    if (overlaps(dst, a) || overlaps(dst, b) || overlaps(activated, a) || overlaps(activated, b))
+    {
+        throw std::invalid_argument("Destination of a matrix product must not alias an operand");
+    }
+    check_destination(dst, a.rows(), b.cols());
+    check_destination(bias, a.rows(), 1);
+    if (bias.rows() > 1 && bias.stride() != 1)
+    {
+        throw std::invalid_argument("Bias column must be contiguous");
+    }
+
+    gemm::Epilogue<Scalar> epilogue;
+    epilogue.bias = bias.data();
+    epilogue.activation = activation;
+
+    if (activated.data() != nullptr)
+    {
+        check_destination(activated, a.rows(), b.cols());
+        epilogue.out = activated.data();
+        epilogue.ldo = activated.stride();
+    }
+
+    blas::gemm(gemm::Trans::No, gemm::Trans::No, a.rows(), b.cols(), a.cols(),
+               Scalar(1), a.data(), a.stride(),
+               b.data(), b.stride(),
+               Scalar(0), dst.data(), dst.stride(), epilogue);
 }
 
-Matrix Matrix::transpose() const
+void Matrix::transpose_into(MatrixView dst, ConstMatrixView a)
 {
-    Matrix trans = Matrix(col, row);
+    if (overlaps(dst, a))
+    {
+        throw std::invalid_argument("Destination of a transpose must not alias its source");
+    }
+    check_destination(dst, a.cols(), a.rows());
 
-    for (int r = 0; r < row; ++r) 
+    for (size_t r = 0; r < a.rows(); ++r) 
     {
-        for (int c = 0; c < col; ++c) 
+        const Scalar* a_row = a.row_data(r);
+        for (size_t c = 0; c < a.cols(); ++c) 
         {
-            trans.data[c * row + r] = data[r * col + c];
+            dst.row_data(c)[r] = a_row[c];
         }
     }
-
-    return trans;
 }
 
-// Activation functions
+void Matrix::broadcast_into(MatrixView dst, ConstMatrixView column)
+{
+    if (column.cols() != 1 || column.rows() != dst.rows())
+    {
+        throw std::invalid_argument(
+            "Cannot broadcast a " + std::to_string(column.rows()) + "x" + std::to_string(column.cols()) +
+            " matrix over " + std::to_string(dst.rows()) + " rows"
+        );
+    }
 
-Matrix Matrix::relu() const
+    for (size_t r = 0; r < dst.rows(); r++)
+    {
+        std::fill(dst.row_data(r), dst.row_data(r) + dst.cols(), column.get(r, 0));
+    }
+}
+
+void Matrix::sum_cols_into(MatrixView dst, ConstMatrixView a, Scalar alpha)
 {
-    Matrix relu = Matrix(row, col);
+    check_destination(dst, a.rows(), 1);
 
-    for (size_t i = 0; i < row * col; i++)
+    for (size_t r = 0; r < a.rows(); r++)
     {
-        if (data[i] < 0) relu.data[i] = 0;
-        else relu.data[i] = data[i];
+        const Scalar* a_row = a.row_data(r);
+        Scalar sum = 0.0;
+        for (size_t c = 0; c < a.cols(); c++) sum += a_row[c];
+        dst.set(r, 0, alpha * sum);
     }
+}
+
+// Activation functions
 
+Matrix Matrix::relu() const
+{
+    Matrix relu = Matrix(row, col);
+    relu_into(relu, *this);
     return relu;
 }
 
 Matrix Matrix::drelu() const
 {
     Matrix drelu = Matrix(row, col);
-
-    for (size_t i = 0; i < row * col; i++)
-    {
-        drelu.data[i] = data[i] > 0 ? 1 : 0;
-    }
-
+    drelu_into(drelu, *this);
     return drelu;
 }
 
 Matrix Matrix::softmax() const
 {
     Matrix softmax(row, col);
+    softmax_into(softmax, *this);
+    return softmax;
+}
 
-    for (size_t c = 0; c < col; ++c)
+void Matrix::relu_into(MatrixView dst, ConstMatrixView a)
+{
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, a, a, [](Scalar* out, const Scalar* x, const Scalar*, size_t n)
     {
-        // 1) max nella colonna c
-        double max_val = data[c];
-        for (size_t r = 1; r < row; ++r)
-        {
-            double v = data[r * col + c];
-            if (v > max_val) max_val = v;
-        }
+        kernels::active().relu(x, out, n);
+    });
+}
 
-        // 2) exp(x - max) e somma
-        double sum = 0.0;
-        for (size_t r = 0; r < row; ++r)
-        {
-            double e = std::exp(data[r * col + c] - max_val);
-            softmax.data[r * col + c] = e;
-            sum += e;
-        }
+void Matrix::drelu_into(MatrixView dst, ConstMatrixView a)
+{
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, a, a, [](Scalar* out, const Scalar* x, const Scalar*, size_t n)
+    {
+        kernels::active().drelu(x, out, n);
+    });
+}
 
-        // 3) normalizzazione
-        if (sum != 0.0)
-        {
-            for (size_t r = 0; r < row; ++r)
-            {
-                softmax.data[r * col + c] /= sum;
-            }
-        }
-    }
+void Matrix::relu_backward_into(MatrixView dst, ConstMatrixView grad, ConstMatrixView a)
+{
+    check_same_shape(grad, a, "Matrix dimensions must match for relu backward");
+    check_destination(dst, a.rows(), a.cols());
+    for_each_row(dst, grad, a, [](Scalar* out, const Scalar* g, const Scalar* x, size_t n)
+    {
+        kernels::active().relu_backward(g, x, out, n);
+    });
+}
 
-    return softmax;
+void Matrix::softmax_into(MatrixView dst, ConstMatrixView a)
+{
+    check_destination(dst, a.rows(), a.cols());
+    kernels::active().softmax(a.data(), a.stride(), dst.data(), dst.stride(), a.rows(), a.cols());
 }
 
 void Matrix::print() const
@@ -206,8 +519,8 @@ void Matrix::print() const
     {
         for (size_t c = 0; c < col; c++)
         {
-            std::cout << data[r * col + c] << " ";
+            std::cout << values[r * col + c] << " ";
         }
         std::cout << std::endl;
     }
-}
\ No newline at end of file
+}
@@ -1,11 +1,63 @@
 #include "ModelIO.hpp"
 #include "Network.hpp"
+#include "InferenceModel.hpp"
+#include "QuantizedModel.hpp"
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <string>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+constexpr char ModelIO::MAGIC[4];
+
+void ModelIO::write_header(std::ofstream& file, Precision precision)
+{
+    uint32_t version = VERSION;
+    int32_t tag = static_cast<int32_t>(precision);
+
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&tag), sizeof(int32_t));
+}
+
+Precision ModelIO::read_header(std::ifstream& file, uint32_t& version)
+{
+    char magic[sizeof(MAGIC)];
+    file.read(magic, sizeof(magic));
+
+    if (!file.good() || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        // Legacy checkpoint: no header, per-layer float64 matrices
+        file.clear();
+        file.seekg(0);
+        version = 1;
+        return Precision::Float64;
+    }
+
+    int32_t precision;
+    file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(&precision), sizeof(int32_t));
+
+    if (version == 0 || version > VERSION)
+    {
+        throw std::runtime_error("Error: Unsupported checkpoint version " + std::to_string(version));
+    }
+    if (precision != static_cast<int32_t>(Precision::Int8) &&
+        precision != static_cast<int32_t>(Precision::Float32) &&
+        precision != static_cast<int32_t>(Precision::Float64))
+    {
+        throw std::runtime_error("Error: Unknown checkpoint precision " + std::to_string(precision));
+    }
+
+    return static_cast<Precision>(precision);
+}
 
 void ModelIO::write_matrix(std::ofstream& file, const Matrix& matrix)
 {
@@ -15,21 +67,166 @@ void ModelIO::write_matrix(std::ofstream& file, const Matrix& matrix)
     file.write(reinterpret_cast<const char*>(&rows), sizeof(size_t));
     file.write(reinterpret_cast<const char*>(&cols), sizeof(size_t));
     
-    const std::vector<double>& data = matrix.get_data();
-    file.write(reinterpret_cast<const char*>(data.data()), rows * cols * sizeof(double));
+    file.write(reinterpret_cast<const char*>(matrix.data()), rows * cols * sizeof(Scalar));
+}
+
+template <class Stored>
+static std::vector<Scalar> read_elements(std::ifstream& file, size_t count)
+{
+    std::vector<Stored> stored(count);
+    file.read(reinterpret_cast<char*>(stored.data()), count * sizeof(Stored));
+
+    return std::vector<Scalar>(stored.begin(), stored.end());
+}
+
+static void check_float_checkpoint(Precision precision, const std::string& filepath)
+{
+    if (precision == Precision::Int8)
+    {
+        throw std::runtime_error("Error: " + filepath + " is a quantized checkpoint; load it with QuantizedModel::load");
+    }
 }
 
-Matrix ModelIO::read_matrix(std::ifstream& file)
+static void read_values(std::ifstream& file, Precision precision, Scalar* data, size_t count)
+{
+    if (precision == SCALAR_PRECISION)
+    {
+        file.read(reinterpret_cast<char*>(data), count * sizeof(Scalar));
+        return;
+    }
+
+    const std::vector<Scalar> values = precision == Precision::Float32
+        ? read_elements<float>(file, count)
+        : read_elements<double>(file, count);
+    std::copy(values.begin(), values.end(), data);
+}
+
+void ModelIO::write_block(std::ofstream& file, const Scalar* data, size_t count)
+{
+    file.write(reinterpret_cast<const char*>(&count), sizeof(size_t));
+    file.write(reinterpret_cast<const char*>(data), count * sizeof(Scalar));
+}
+
+void ModelIO::read_block(std::ifstream& file, Precision precision, Scalar* data, size_t count)
+{
+    size_t stored;
+    file.read(reinterpret_cast<char*>(&stored), sizeof(size_t));
+
+    if (stored != count)
+    {
+        throw std::runtime_error(
+            "Error: Checkpoint block holds " + std::to_string(stored) + " values, network has " +
+            std::to_string(count)
+        );
+    }
+
+    read_values(file, precision, data, count);
+}
+
+void ModelIO::skip_block(std::ifstream& file, Precision precision)
+{
+    size_t stored;
+    file.read(reinterpret_cast<char*>(&stored), sizeof(size_t));
+    file.seekg(static_cast<std::streamoff>(stored * static_cast<size_t>(precision)), std::ios::cur);
+}
+
+void ModelIO::write_optimizer(std::ofstream& file, const Optimizer& optimizer)
+{
+    int type = static_cast<int>(optimizer.get_type());
+    double beta1 = optimizer.get_beta1();
+    double beta2 = optimizer.get_beta2();
+    double epsilon = optimizer.get_epsilon();
+    double weight_decay = optimizer.get_weight_decay();
+    uint64_t steps = optimizer.get_steps();
+
+    file.write(reinterpret_cast<const char*>(&type), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&beta1), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&beta2), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&epsilon), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&weight_decay), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&steps), sizeof(uint64_t));
+}
+
+Optimizer ModelIO::read_optimizer(std::ifstream& file)
+{
+    int type;
+    double beta1, beta2, epsilon, weight_decay;
+    uint64_t steps;
+
+    file.read(reinterpret_cast<char*>(&type), sizeof(int));
+    file.read(reinterpret_cast<char*>(&beta1), sizeof(double));
+    file.read(reinterpret_cast<char*>(&beta2), sizeof(double));
+    file.read(reinterpret_cast<char*>(&epsilon), sizeof(double));
+    file.read(reinterpret_cast<char*>(&weight_decay), sizeof(double));
+    file.read(reinterpret_cast<char*>(&steps), sizeof(uint64_t));
+
+    if (!file)
+    {
+        throw std::runtime_error("Error: Unexpected end of file in optimizer record");
+    }
+
+    Optimizer optimizer = Optimizer::sgd_momentum();
+    switch (static_cast<OptimizerType>(type))
+    {
+        case OptimizerType::SGD_MOMENTUM: optimizer = Optimizer::sgd_momentum(beta1); break;
+        case OptimizerType::NESTEROV: optimizer = Optimizer::nesterov(beta1); break;
+        case OptimizerType::ADAM: optimizer = Optimizer::adam(beta1, beta2, epsilon); break;
+        case OptimizerType::ADAMW: optimizer = Optimizer::adamw(weight_decay, beta1, beta2, epsilon); break;
+        case OptimizerType::RMSPROP: optimizer = Optimizer::rmsprop(beta2, epsilon); break;
+        default: throw std::runtime_error("Error: Unknown optimizer type " + std::to_string(type));
+    }
+
+    optimizer.set_steps(steps);
+    return optimizer;
+}
+
+Matrix ModelIO::read_matrix(std::ifstream& file, Precision precision)
 {
     size_t rows, cols;
     
     file.read(reinterpret_cast<char*>(&rows), sizeof(size_t));
     file.read(reinterpret_cast<char*>(&cols), sizeof(size_t));
     
-    std::vector<double> data(rows * cols);
-    file.read(reinterpret_cast<char*>(data.data()), rows * cols * sizeof(double));
-    
-    return Matrix(rows, cols, data);
+    if (precision == SCALAR_PRECISION)
+    {
+        std::vector<Scalar> data(rows * cols);
+        file.read(reinterpret_cast<char*>(data.data()), rows * cols * sizeof(Scalar));
+        return Matrix(rows, cols, data);
+    }
+
+    if (precision == Precision::Float32)
+    {
+        return Matrix(rows, cols, read_elements<float>(file, rows * cols));
+    }
+
+    return Matrix(rows, cols, read_elements<double>(file, rows * cols));
+}
+
+void ModelIO::read_matrix_into(std::ifstream& file, Precision precision, Scalar* data, size_t rows, size_t cols)
+{
+    size_t stored_rows, stored_cols;
+
+    file.read(reinterpret_cast<char*>(&stored_rows), sizeof(size_t));
+    file.read(reinterpret_cast<char*>(&stored_cols), sizeof(size_t));
+
+    if (stored_rows != rows || stored_cols != cols)
+    {
+        throw std::runtime_error(
+            "Error: Checkpoint matrix is " + std::to_string(stored_rows) + "x" + std::to_string(stored_cols) +
+            ", expected " + std::to_string(rows) + "x" + std::to_string(cols)
+        );
+    }
+
+    read_values(file, precision, data, rows * cols);
+}
+
+void ModelIO::skip_matrix(std::ifstream& file, Precision precision)
+{
+    size_t rows, cols;
+
+    file.read(reinterpret_cast<char*>(&rows), sizeof(size_t));
+    file.read(reinterpret_cast<char*>(&cols), sizeof(size_t));
+    file.seekg(static_cast<std::streamoff>(rows * cols * static_cast<size_t>(precision)), std::ios::cur);
 }
 
 void ModelIO::write_layer(std::ofstream& file, const Layer& layer)
@@ -48,7 +245,7 @@ void ModelIO::write_layer(std::ofstream& file, const Layer& layer)
     write_matrix(file, layer.getvb());
 }
 
-Layer ModelIO::read_layer(std::ifstream& file)
+Layer ModelIO::read_layer(std::ifstream& file, Precision precision)
 {
     size_t input_size, output_size;
     int activation_int;
@@ -61,10 +258,10 @@ Layer ModelIO::read_layer(std::ifstream& file)
     
     Layer layer(input_size, output_size, activation);
     
-    Matrix W = read_matrix(file);
-    Matrix b = read_matrix(file);
-    Matrix vW = read_matrix(file);
-    Matrix vb = read_matrix(file);
+    Matrix W = read_matrix(file, precision);
+    Matrix b = read_matrix(file, precision);
+    Matrix vW = read_matrix(file, precision);
+    Matrix vb = read_matrix(file, precision);
     
     layer.setW(W);
     layer.setb(b);
@@ -74,74 +271,168 @@ Layer ModelIO::read_layer(std::ifstream& file)
     return layer;
 }
 
-void ModelIO::save_model(const Network& network, const std::string& filepath)
+void ModelIO::capture(const Network& network, Snapshot& snapshot)
+{
+    const std::vector<Layer>& layers = network.get_layers();
+
+    snapshot.layers.resize(layers.size());
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        snapshot.layers[i].input_size = layers[i].get_input_size();
+        snapshot.layers[i].output_size = layers[i].get_output_size();
+        snapshot.layers[i].activation = layers[i].get_activation();
+    }
+
+    snapshot.optimizer = network.get_optimizer();
+
+    // assign() reuses the vectors' capacity, so repeated captures of the
+    // same network do not allocate
+    const ParameterStore& parameters = network.get_parameters();
+    const size_t state_size = parameters.size() * parameters.state_slots();
+    snapshot.parameters.assign(parameters.parameters(), parameters.parameters() + parameters.size());
+    snapshot.state.assign(parameters.state(), parameters.state() + state_size);
+
+    snapshot.loss_type = network.get_loss_type();
+    snapshot.learning_rate = network.get_learning_rate();
+    snapshot.best_accuracy = network.get_best_accuracy();
+    snapshot.patience = network.get_patience();
+    snapshot.factor = network.get_factor();
+    snapshot.min_lr = network.get_min_lr();
+    snapshot.min_delta = network.get_min_delta();
+}
+
+void ModelIO::create_directories(const std::string& dir)
 {
+    for (size_t end = dir.find_first_of("/\\", 1); ; end = dir.find_first_of("/\\", end + 1))
+    {
+        const std::string prefix = dir.substr(0, end);
+        if (::mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            throw std::runtime_error("Error: Cannot create directory: " + prefix + " (" + std::strerror(errno) + ")");
+        }
+        if (end == std::string::npos) break;
+    }
+}
+
+// Flushes a file's (or directory's) contents to stable storage
+static void sync_path(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Error: Cannot open " + path + " to sync it (" + std::strerror(errno) + ")");
+    }
+    const int result = ::fsync(fd);
+    ::close(fd);
+
+    if (result != 0)
+    {
+        throw std::runtime_error("Error: Failed to sync " + path + " (" + std::strerror(errno) + ")");
+    }
+}
+
+// Creates filepath's directory if needed and returns it
+static std::string prepare_directory(const std::string& filepath)
+{
+    std::string dir = ".";
     size_t last_slash = filepath.find_last_of("/\\");
     if (last_slash != std::string::npos)
     {
-        std::string dir = filepath.substr(0, last_slash);
+        dir = last_slash == 0 ? "/" : filepath.substr(0, last_slash);
         struct stat info;
         if (stat(dir.c_str(), &info) != 0)
         {
-            std::string mkdir_cmd = "mkdir -p " + dir;
-            int result = system(mkdir_cmd.c_str());
-            if (result != 0)
-            {
-                throw std::runtime_error("Error: Cannot create directory: " + dir);
-            }
+            ModelIO::create_directories(dir);
         }
     }
+    return dir;
+}
+
+// Closes file, written to temp_path, fsyncs it and renames it over filepath
+static void replace_file(std::ofstream& file, const std::string& temp_path, const std::string& filepath,
+                         const std::string& dir)
+{
+    file.close();
     
-    std::ofstream file(filepath, std::ios::binary);
-    if (!file.is_open())
+    if (file.fail())
     {
-        throw std::runtime_error("Error: Cannot open file for writing: " + filepath);
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Error: Failed to write data to file: " + temp_path);
     }
-    
-    if (!file.good())
+
+    try
     {
-        file.close();
-        throw std::runtime_error("Error: File stream is not in good state: " + filepath);
+        sync_path(temp_path);
     }
-    
-    const std::vector<Layer>& layers = network.get_layers();
-    size_t num_layers = layers.size();
-    
-    file.write(reinterpret_cast<const char*>(&num_layers), sizeof(size_t));
-    
-    for (const auto& layer : layers)
+    catch (...)
     {
-        write_layer(file, layer);
+        std::remove(temp_path.c_str());
+        throw;
     }
-    
-    int loss_type_int = static_cast<int>(network.get_loss_type());
-    double learning_rate = network.get_learning_rate();
-    double best_accuracy = network.get_best_accuracy();
-    size_t patience = network.get_patience();
-    double factor = network.get_factor();
-    double min_lr = network.get_min_lr();
-    double min_delta = network.get_min_delta();
-    
-    file.write(reinterpret_cast<const char*>(&loss_type_int), sizeof(int));
-    file.write(reinterpret_cast<const char*>(&learning_rate), sizeof(double));
-    file.write(reinterpret_cast<const char*>(&best_accuracy), sizeof(double));
-    file.write(reinterpret_cast<const char*>(&patience), sizeof(size_t));
-    file.write(reinterpret_cast<const char*>(&factor), sizeof(double));
-    file.write(reinterpret_cast<const char*>(&min_lr), sizeof(double));
-    file.write(reinterpret_cast<const char*>(&min_delta), sizeof(double));
-    
-    if (!file.good())
+
+    if (std::rename(temp_path.c_str(), filepath.c_str()) != 0)
     {
-        file.close();
-        throw std::runtime_error("Error: Failed to write data to file: " + filepath);
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Error: Cannot replace " + filepath + " (" + std::strerror(errno) + ")");
+    }
+
+    // Persist the rename itself
+    sync_path(dir);
+}
+
+void ModelIO::write_snapshot(const Snapshot& snapshot, const std::string& filepath)
+{
+    const std::string dir = prepare_directory(filepath);
+
+    // Written beside the target and renamed over it once complete, so
+    // readers only ever see a whole checkpoint
+    const std::string temp_path = filepath + ".tmp";
+
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Error: Cannot open file for writing: " + temp_path);
     }
     
-    file.close();
+    write_header(file);
+
+    size_t num_layers = snapshot.layers.size();
+    file.write(reinterpret_cast<const char*>(&num_layers), sizeof(size_t));
     
-    if (!file.good() && !file.eof())
+    for (const LayerShape& layer : snapshot.layers)
     {
-        throw std::runtime_error("Error: Failed to close file properly: " + filepath);
+        size_t input_size = layer.input_size;
+        size_t output_size = layer.output_size;
+        int activation = static_cast<int>(layer.activation);
+
+        file.write(reinterpret_cast<const char*>(&input_size), sizeof(size_t));
+        file.write(reinterpret_cast<const char*>(&output_size), sizeof(size_t));
+        file.write(reinterpret_cast<const char*>(&activation), sizeof(int));
     }
+
+    write_optimizer(file, snapshot.optimizer);
+
+    write_block(file, snapshot.parameters.data(), snapshot.parameters.size());
+    write_block(file, snapshot.state.data(), snapshot.state.size());
+    
+    int loss_type_int = static_cast<int>(snapshot.loss_type);
+    
+    file.write(reinterpret_cast<const char*>(&loss_type_int), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&snapshot.learning_rate), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&snapshot.best_accuracy), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&snapshot.patience), sizeof(size_t));
+    file.write(reinterpret_cast<const char*>(&snapshot.factor), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&snapshot.min_lr), sizeof(double));
+    file.write(reinterpret_cast<const char*>(&snapshot.min_delta), sizeof(double));
+    
+    replace_file(file, temp_path, filepath, dir);
+}
+
+void ModelIO::save_model(const Network& network, const std::string& filepath)
+{
+    Snapshot snapshot;
+    capture(network, snapshot);
+    write_snapshot(snapshot, filepath);
     
     std::cout << "Model saved to: " << filepath << std::endl;
 }
@@ -166,6 +457,10 @@ void ModelIO::load_model(Network& network, const std::string& filepath)
         throw std::runtime_error("Error: File stream is not in good state: " + filepath);
     }
     
+    uint32_t version;
+    Precision precision = read_header(file, version);
+    check_float_checkpoint(precision, filepath);
+
     size_t num_layers;
     file.read(reinterpret_cast<char*>(&num_layers), sizeof(size_t));
     
@@ -193,17 +488,58 @@ void ModelIO::load_model(Network& network, const std::string& filepath)
             file.close();
             throw std::runtime_error("Error: Layer " + std::to_string(i) + " architecture mismatch");
         }
+
+        if (version >= 2) continue;
         
-        Matrix W = read_matrix(file);
-        Matrix b = read_matrix(file);
-        Matrix vW = read_matrix(file);
-        Matrix vb = read_matrix(file);
+        Matrix W = read_matrix(file, precision);
+        Matrix b = read_matrix(file, precision);
+        Matrix vW = read_matrix(file, precision);
+        Matrix vb = read_matrix(file, precision);
         
         network.get_layers()[i].setW(W);
         network.get_layers()[i].setb(b);
         network.get_layers()[i].setvW(vW);
         network.get_layers()[i].setvb(vb);
     }
+
+    // The stored optimizer replaces the network's, so training resumes
+    // with the same rule, hyperparameters, state and step count. Older
+    // files hold SGD momentum state (vW, vb) and no record.
+    uint64_t steps = 0;
+    if (version >= 3)
+    {
+        const Optimizer stored = read_optimizer(file);
+        steps = stored.get_steps();
+        network.set_optimizer(stored);
+    }
+
+    Optimizer& optimizer = network.get_optimizer();
+    ParameterStore& parameters = network.get_parameters();
+    const bool keep_state = version >= 3 || optimizer.get_type() == OptimizerType::SGD_MOMENTUM;
+
+    if (version >= 2)
+    {
+        read_block(file, precision, parameters.parameters(), parameters.size());
+
+        if (keep_state)
+        {
+            read_block(file, precision, parameters.state(), parameters.size() * parameters.state_slots());
+        }
+        else
+        {
+            skip_block(file, precision);
+        }
+    }
+
+    if (keep_state)
+    {
+        optimizer.set_steps(steps);
+    }
+    else
+    {
+        parameters.clear_state();
+        optimizer.set_steps(0);
+    }
     
     int loss_type_int;
     double loaded_learning_rate;
@@ -243,3 +579,217 @@ void ModelIO::load_model(Network& network, const std::string& filepath)
     
     std::cout << "Model loaded from: " << filepath << std::endl;
 }
+
+InferenceModel ModelIO::load_inference(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Error: Cannot open file for reading: " + filepath);
+    }
+
+    uint32_t version;
+    Precision precision = read_header(file, version);
+    check_float_checkpoint(precision, filepath);
+
+    size_t num_layers;
+    file.read(reinterpret_cast<char*>(&num_layers), sizeof(size_t));
+
+    if (!file.good() || num_layers == 0)
+    {
+        throw std::runtime_error("Error: Checkpoint has no layers: " + filepath);
+    }
+
+    // Version 1 interleaves each layer's matrices with its shape, so the
+    // weights are read as the shapes come and copied in afterwards
+    std::vector<LayerShape> shapes;
+    std::vector<std::streampos> weights_at;
+
+    for (size_t i = 0; i < num_layers; i++)
+    {
+        size_t input_size, output_size;
+        int activation_int;
+
+        file.read(reinterpret_cast<char*>(&input_size), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&output_size), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&activation_int), sizeof(int));
+
+        if (!file.good())
+        {
+            throw std::runtime_error("Error: Failed to read layer " + std::to_string(i) + " from file: " + filepath);
+        }
+
+        shapes.push_back({ input_size, output_size, static_cast<Activation>(activation_int) });
+
+        if (version >= 2) continue;
+
+        weights_at.push_back(file.tellg());
+        for (int m = 0; m < 4; m++)
+        {
+            skip_matrix(file, precision);
+        }
+    }
+
+    InferenceModel model(std::move(shapes));
+
+    if (version >= 3)
+    {
+        read_optimizer(file);
+    }
+
+    if (version >= 2)
+    {
+        // The state block that follows is never touched
+        read_block(file, precision, model.parameters(), model.parameter_count());
+    }
+    else
+    {
+        Scalar* p = model.parameters();
+        for (size_t i = 0; i < num_layers; i++)
+        {
+            const LayerShape& shape = model.get_layers()[i];
+
+            file.seekg(weights_at[i]);
+            read_matrix_into(file, precision, p, shape.output_size, shape.input_size);
+            p += shape.output_size * shape.input_size;
+            read_matrix_into(file, precision, p, shape.output_size, 1);
+            p += shape.output_size;
+        }
+    }
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Error: Failed to read data from file: " + filepath);
+    }
+
+    return model;
+}
+
+template <class T>
+static void write_array(std::ofstream& file, const T* data, size_t count)
+{
+    file.write(reinterpret_cast<const char*>(&count), sizeof(size_t));
+    file.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template <class T>
+static std::vector<T> read_array(std::ifstream& file, size_t count)
+{
+    size_t stored;
+    file.read(reinterpret_cast<char*>(&stored), sizeof(size_t));
+
+    if (!file.good() || stored != count)
+    {
+        throw std::runtime_error(
+            "Error: Checkpoint block holds " + std::to_string(stored) + " values, expected " + std::to_string(count)
+        );
+    }
+
+    std::vector<T> values(count);
+    file.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+    return values;
+}
+
+void ModelIO::save_quantized(const QuantizedModel& model, const std::string& filepath)
+{
+    const std::string dir = prepare_directory(filepath);
+    const std::string temp_path = filepath + ".tmp";
+
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Error: Cannot open file for writing: " + temp_path);
+    }
+
+    write_header(file, Precision::Int8);
+
+    const std::vector<QuantizedModel::QuantizedLayer>& layers = model.get_layers();
+    size_t num_layers = layers.size();
+    file.write(reinterpret_cast<const char*>(&num_layers), sizeof(size_t));
+
+    for (const QuantizedModel::QuantizedLayer& layer : layers)
+    {
+        int activation = static_cast<int>(layer.activation);
+
+        file.write(reinterpret_cast<const char*>(&layer.input_size), sizeof(size_t));
+        file.write(reinterpret_cast<const char*>(&layer.output_size), sizeof(size_t));
+        file.write(reinterpret_cast<const char*>(&activation), sizeof(int));
+    }
+
+    write_array(file, model.get_input_scale().data(), model.get_input_scale().size());
+
+    for (const QuantizedModel::QuantizedLayer& layer : layers)
+    {
+        // Plain row-major, without the kernels' packing and padding
+        std::vector<int8_t> weights(layer.output_size * layer.input_size);
+        for (size_t i = 0; i < layer.output_size; i++)
+        {
+            for (size_t k = 0; k < layer.input_size; k++)
+            {
+                weights[i * layer.input_size + k] = layer.weight(i, k);
+            }
+        }
+
+        write_array(file, weights.data(), weights.size());
+        write_array(file, layer.scale.data(), layer.output_size);
+        write_array(file, layer.bias.data(), layer.output_size);
+    }
+
+    replace_file(file, temp_path, filepath, dir);
+}
+
+QuantizedModel ModelIO::load_quantized(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Error: Cannot open file for reading: " + filepath);
+    }
+
+    uint32_t version;
+    if (read_header(file, version) != Precision::Int8)
+    {
+        throw std::runtime_error("Error: " + filepath + " is not a quantized checkpoint");
+    }
+
+    size_t num_layers;
+    file.read(reinterpret_cast<char*>(&num_layers), sizeof(size_t));
+
+    if (!file.good() || num_layers == 0)
+    {
+        throw std::runtime_error("Error: Checkpoint has no layers: " + filepath);
+    }
+
+    std::vector<LayerShape> shapes(num_layers);
+    for (LayerShape& shape : shapes)
+    {
+        int activation_int;
+
+        file.read(reinterpret_cast<char*>(&shape.input_size), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&shape.output_size), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&activation_int), sizeof(int));
+
+        shape.activation = static_cast<Activation>(activation_int);
+    }
+
+    std::vector<float> input_scale = read_array<float>(file, shapes.front().input_size);
+
+    std::vector<QuantizedModel::QuantizedLayer> layers;
+    for (const LayerShape& shape : shapes)
+    {
+        const std::vector<int8_t> weights = read_array<int8_t>(file, shape.output_size * shape.input_size);
+        std::vector<float> scale = read_array<float>(file, shape.output_size);
+        std::vector<float> bias = read_array<float>(file, shape.output_size);
+
+        layers.push_back(QuantizedModel::make_layer(
+            shape.input_size, shape.output_size, shape.activation, weights.data(), std::move(scale), std::move(bias)
+        ));
+    }
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Error: Failed to read data from file: " + filepath);
+    }
+
+    return QuantizedModel(std::move(layers), std::move(input_scale));
+}
@@ -1,8 +1,15 @@
 // network.cpp
 
 #include "Network.hpp"
+#include "CheckpointWriter.hpp"
+#include "InferenceSession.hpp"
+#include "Pipeline.hpp"
+#include "Validator.hpp"
 #include "TrainingLogger.hpp"
 #include "ModelIO.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <string>
 
@@ -17,12 +24,102 @@ Network::Network(std::vector<Layer> layers_param, double learning_rate, InitType
         throw std::invalid_argument("Error: Network must have at least 2 layers");
     }
     
+    plan_parameters();
+    plan_workspace(1);
+    init_weights(init_type);
+}
+
+Network::~Network() = default;
+
+Network::Network(Network& master, size_t capacity)
+    : layers(master.layers),
+      loss_type(master.loss_type),
+      optimizer(master.optimizer),
+      max_grad_norm(master.max_grad_norm),
+      learning_rate(master.learning_rate)
+{
+    plan_parameters();
+    parameters.share_parameters(master.parameters);
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        layers[i].share_parameters(master.layers[i]);
+    }
+
+    plan_workspace(capacity);
+}
+
+// Parameters and workspace
+
+void Network::plan_parameters()
+{
+    size_t count = 0;
+    for (const Layer& layer : layers)
+    {
+        count += layer.parameter_count();
+    }
+
+    // Layers copy their values out of the current store while binding,
+    // so it is only released afterwards
+    ParameterStore next(count, optimizer.state_slots());
+
+    size_t offset = 0;
+    for (Layer& layer : layers)
+    {
+        layer.bind_parameters(next.parameters() + offset,
+                              next.gradients() + offset,
+                              next.state() + offset);
+        offset += layer.parameter_count();
+    }
+
+    parameters = std::move(next);
+}
+
+void Network::plan_workspace(size_t capacity)
+{
+    size_t workspace = 0;
+    for (const Layer& layer : layers)
+    {
+        workspace += layer.workspace_size(capacity);
+    }
+
+    // Activations are scratch, so nothing is copied across
+    Arena next(workspace);
+    for (Layer& layer : layers)
+    {
+        layer.bind(next, capacity);
+    }
+    arena = std::move(next);
+    batch_capacity = capacity;
+
     for (size_t i = 1; i < layers.size(); i++)
     {
         layers[i].connect_prev(layers[i - 1]);
     }
+}
 
-    init_weights(init_type);
+void Network::reserve_batch(size_t capacity)
+{
+    if (capacity > batch_capacity)
+    {
+        plan_workspace(capacity);
+    }
+}
+
+void Network::set_batch(size_t batch)
+{
+    if (batch == layers[0].get_batch()) return;
+
+    reserve_batch(batch);
+    for (Layer& layer : layers)
+    {
+        layer.set_batch(batch);
+    }
+
+    for (size_t i = 1; i < layers.size(); i++)
+    {
+        layers[i].connect_prev(layers[i - 1]);
+    }
 }
 
 // Init weights
@@ -37,147 +134,652 @@ void Network::init_weights(InitType init_type)
 
 const Matrix& Network::get_output() const { return layers.back().getA(); }
 
-void Network::train(Dataset& dataset, size_t epochs)
+void Network::set_num_threads(size_t threads)
 {
-    dataset_size = dataset.size();
-    TrainingLogger logger;
+    num_threads = threads == 0 ? 1 : threads;
 
-    for (size_t epoch = 0; epoch <= epochs; epoch++)
+    ThreadPool& pool = ThreadPool::global();
+    if (pool.size() < num_threads)
+    {
+        pool.resize(num_threads);
+    }
+}
+
+void Network::build_replicas(size_t workers, size_t capacity)
+{
+    replicas.clear();
+    for (size_t r = 1; r < workers; r++)
     {
-        dataset.shuffle();
+        replicas.emplace_back(new Network(*this, capacity));
+    }
+}
 
-        for (size_t i = 0; i < dataset.size(); i++)
+void Network::build_pipeline(size_t stages, size_t parts)
+{
+    stage_layers.assign(stages + 1, layers.size());
+    stage_params.assign(stages + 1, parameters.size());
+
+    size_t offset = 0;
+    for (size_t s = 0, i = 0; s < stages; s++)
+    {
+        stage_layers[s] = s * layers.size() / stages;
+        for (; i < stage_layers[s]; i++)
         {
-            forward(dataset.get_input(i));
+            offset += layers[i].parameter_count();
+        }
+        stage_params[s] = offset;
+    }
 
-            size_t label = dataset.get_output(i);
-            Matrix& pred = layers.back().getA();
-            
-            accumulate_loss(pred, label);
-            compute_accuracy(pred, label);
+    pipeline.reset(new Pipeline(stages, parts));
+}
+
+void Network::merge_replica_metrics()
+{
+    for (std::unique_ptr<Network>& replica : replicas)
+    {
+        accumulated_loss += replica->accumulated_loss;
+        correct_predictions += replica->correct_predictions;
+        replica->reset_epoch_metrics();
+    }
+}
+
+// Hogwild workers each hold a batch while the next ones are gathered
+static size_t prefetch_slots(TrainStrategy strategy, size_t threads)
+{
+    return strategy == TrainStrategy::HOGWILD && threads > 1 ? threads + 2 : 2;
+}
+
+void Network::train(Dataset& dataset, size_t epochs, size_t batch_size)
+{
+    if (batch_size == 0)
+    {
+        throw std::invalid_argument("Error: Batch size must be at least 1");
+    }
+
+    DataLoader loader(dataset, batch_size, prefetch_slots(strategy, num_threads));
+    run_training(loader, nullptr, epochs);
+}
 
-            backprop(label);
-            step(learning_rate);
+void Network::train(DataLoader& loader, size_t epochs)
+{
+    run_training(loader, nullptr, epochs);
+}
+
+void Network::train(Dataset& dataset, const Dataset& validation, size_t epochs, size_t batch_size)
+{
+    if (batch_size == 0)
+    {
+        throw std::invalid_argument("Error: Batch size must be at least 1");
+    }
+
+    DataLoader loader(dataset, batch_size, prefetch_slots(strategy, num_threads));
+    run_training(loader, &validation, epochs);
+}
+
+void Network::train(DataLoader& loader, const Dataset& validation, size_t epochs)
+{
+    run_training(loader, &validation, epochs);
+}
+
+void Network::run_training(DataLoader& loader, const Dataset* validation, size_t epochs)
+{
+    dataset_size = loader.size();
+    const size_t batch_size = loader.get_batch_size();
+    reserve_batch(batch_size);
+
+    // Synchronous workers share each batch; Hogwild workers take whole batches
+    const bool hogwild = strategy == TrainStrategy::HOGWILD && num_threads > 1;
+
+    if (strategy == TrainStrategy::PIPELINE && num_threads > 1)
+    {
+        const size_t stages = std::min(num_threads, layers.size());
+        const size_t parts = std::min(micro_batches > 0 ? micro_batches : 4 * stages, batch_size);
+
+        build_replicas(parts, (batch_size + parts - 1) / parts);
+        build_pipeline(stages, parts);
+    }
+    else
+    {
+        const size_t workers = hogwild ? num_threads : std::min(num_threads, batch_size);
+        build_replicas(workers, hogwild ? batch_size : (batch_size + workers - 1) / workers);
+    }
+
+    std::unique_ptr<Validator> validator;
+    if (validation)
+    {
+        validator.reset(new Validator(*this, *validation, "checkpoints/model.crnn"));
+    }
+    double validation_accuracy = 0.0;
+    stale_evaluations = 0;
+
+    TrainingLogger logger;
+
+    for (size_t epoch = 0; epoch <= epochs; epoch++)
+    {
+        loader.begin_epoch();
+
+        if (hogwild)
+        {
+            train_epoch_hogwild(loader);
+        }
+        else
+        {
+            train_epoch_synchronous(loader);
         }
 
         accuracy = static_cast<double>(correct_predictions) / dataset_size;
         double avg_loss = accumulated_loss / dataset_size;
-        
-        logger.log_epoch(epoch, epochs, accuracy, avg_loss);
-        
-        lr_reduce_on_plateau();
         reset_epoch_metrics();
+
+        bool stop = false;
+
+        if (validator)
+        {
+            // Results arrive an epoch or more late; act on whichever are in
+            validator->submit(*this, epoch);
+
+            Validator::Result result;
+            while (validator->poll(result))
+            {
+                validation_accuracy = result.accuracy;
+                track_plateau(result.accuracy);
+                stop = track_early_stopping(result.improved) || stop;
+            }
+
+            logger.log_epoch(epoch, epochs, accuracy, avg_loss, validation_accuracy);
+        }
+        else
+        {
+            logger.log_epoch(epoch, epochs, accuracy, avg_loss);
+
+            stop = track_early_stopping(lr_reduce_on_plateau());
+        }
+
+        if (stop) break;
+    }
+
+    if (validator)
+    {
+        // The last snapshots may still pick the checkpoint
+        validator->finish();
+
+        Validator::Result result;
+        while (validator->poll(result))
+        {
+            track_plateau(result.accuracy);
+        }
     }
 
+    pipeline.reset();
+
+    if (checkpoints) checkpoints->flush();
+
     logger.log_completion();
 }
 
-void Network::forward(const Matrix& input)
+void Network::train_epoch_synchronous(DataLoader& loader)
 {
-    layers[0].set_prev_A(&input);
+    DataLoader::Batch batch;
 
-    for (size_t i = 0; i < layers.size(); i++)
+    while (loader.next(batch))
     {
-        layers[i].forward(); 
+        train_batch(batch.input, batch.labels);
+        loader.release(batch);
     }
 }
 
-void Network::backprop(size_t label)
+// Hogwild: every worker takes the next batch of the shuffled epoch, runs
+// it through its own activations and steps the shared W and b directly,
+// with no locks. Each worker keeps its own momentum. Concurrent updates
+// to the same weight may overwrite each other; with many small updates
+// that noise is tolerated in exchange for never waiting on other workers.
+void Network::train_epoch_hogwild(DataLoader& loader)
 {
-    loss_gradient(label);
+    ThreadPool::global().parallel_for(replicas.size() + 1, [&](size_t r)
+    {
+        Network& net = worker(r);
+        DataLoader::Batch batch;
 
-    for (size_t i = layers.size(); i-- > 0; )
+        while (loader.next(batch))
+        {
+            net.forward(batch.input);
+
+            const Matrix& pred = net.layers.back().getA();
+            net.accumulate_loss(pred, batch.labels);
+            net.compute_accuracy(pred, batch.labels);
+
+            net.backprop(batch.labels);
+            net.step(learning_rate);
+
+            loader.release(batch);
+        }
+    });
+
+    merge_replica_metrics();
+}
+
+// One optimizer step on a batch. With replicas, the batch is split into
+// column slices processed in parallel; each worker weights its averaged
+// gradients by its share of the batch and a pairwise tree sums them into
+// this network's buffers before the single step.
+void Network::train_batch(ConstMatrixView input, const size_t* labels)
+{
+    if (pipeline)
     {
-        layers[i].backprop();
+        train_batch_pipelined(input, labels);
+        return;
+    }
+
+    const size_t count = input.cols();
+    const size_t workers = std::min(replicas.size() + 1, count);
+
+    if (workers == 1)
+    {
+        forward(input);
+
+        const Matrix& pred = layers.back().getA();
+        accumulate_loss(pred, labels);
+        compute_accuracy(pred, labels);
+
+        backprop(labels);
+        step(learning_rate);
+        return;
+    }
+
+    ThreadPool& pool = ThreadPool::global();
+
+    pool.parallel_for(workers, [&](size_t r)
+    {
+        const size_t begin = r * count / workers;
+        const size_t end = (r + 1) * count / workers;
+        Network& net = worker(r);
+
+        net.forward(input.block(0, begin, input.rows(), end - begin));
+
+        const Matrix& pred = net.layers.back().getA();
+        net.accumulate_loss(pred, labels + begin);
+        net.compute_accuracy(pred, labels + begin);
+
+        net.backprop(labels + begin);
+
+        net.parameters.scale_gradients(Scalar(end - begin) / Scalar(count));
+    });
+
+    for (size_t stride = 1; stride < workers; stride *= 2)
+    {
+        pool.parallel_for((workers + 2 * stride - 1) / (2 * stride), [&](size_t pair)
+        {
+            const size_t r = pair * 2 * stride;
+            if (r + stride >= workers) return;
+
+            worker(r).parameters.add_gradients(worker(r + stride).parameters);
+        });
     }
+
+    merge_replica_metrics();
+    step(learning_rate);
 }
 
-void Network::loss_gradient(size_t label)
+// The same step as train_batch, scheduled by layer instead of by replica:
+// micro-batch r is replica r's slice of the batch, and each stage thread
+// runs its layers on every micro-batch in turn. Each stage then scales and
+// tree-sums its own slice of the replicas' gradients in the same order as
+// train_batch, so both give identical results.
+void Network::train_batch_pipelined(ConstMatrixView input, const size_t* labels)
 {
-    const Matrix& prediction = layers.back().getA();
+    const size_t count = input.cols();
+    const size_t parts = std::min(replicas.size() + 1, count);
 
-    switch (loss_type)
+    pipeline->run(parts, [&](Pipeline::Phase phase, size_t stage, size_t part)
     {
-        case Loss::CROSS_ENTROPY:
+        const size_t first_layer = stage_layers[stage];
+        const size_t end_layer = stage_layers[stage + 1];
+
+        if (phase == Pipeline::Phase::Finish)
         {
-            Matrix dZ = prediction;
-            double v = dZ.get(label, 0);
-            dZ.set(label, 0, v - 1.0);
-            layers.back().set_dZ(dZ);
+            const size_t first_param = stage_params[stage];
+            const size_t end_param = stage_params[stage + 1];
 
-            break;
+            for (size_t r = 0; r < parts; r++)
+            {
+                const size_t share = (r + 1) * count / parts - r * count / parts;
+                worker(r).parameters.scale_gradients(Scalar(share) / Scalar(count), first_param, end_param);
+            }
+            for (size_t stride = 1; stride < parts; stride *= 2)
+            {
+                for (size_t r = 0; r + stride < parts; r += 2 * stride)
+                {
+                    worker(r).parameters.add_gradients(worker(r + stride).parameters, first_param, end_param);
+                }
+            }
+            return;
         }
-        case Loss::MSE:
-        {
-            Matrix target(prediction.rows(), 1);
-            target.fill(0.0);
-            target.set(label, 0, 1.0);
-            
-            Matrix dZ = prediction - target;
 
-            for (size_t i = 0; i < dZ.rows(); i++)
+        const size_t begin = part * count / parts;
+        const size_t end = (part + 1) * count / parts;
+        Network& net = worker(part);
+
+        if (phase == Pipeline::Phase::Forward)
+        {
+            if (first_layer == 0)
             {
-                double val = dZ.get(i, 0);
-                dZ.set(i, 0, 2.0 * val);
+                net.set_batch(end - begin);
+                net.layers[0].set_prev_A(input.block(0, begin, input.rows(), end - begin));
             }
+            for (size_t i = first_layer; i < end_layer; i++)
+            {
+                net.layers[i].forward();
+            }
+            return;
+        }
 
-            layers.back().set_dZ(dZ);
+        if (end_layer == layers.size())
+        {
+            const Matrix& pred = net.layers.back().getA();
+            net.accumulate_loss(pred, labels + begin);
+            net.compute_accuracy(pred, labels + begin);
 
-            break;
+            net.loss_gradient(labels + begin);
+        }
+        for (size_t i = end_layer; i-- > first_layer; )
+        {
+            net.layers[i].backprop();
+        }
+    });
+
+    merge_replica_metrics();
+    step(learning_rate);
+}
+
+double Network::evaluate(const Dataset& dataset, size_t batch_size, double& loss)
+{
+    if (batch_size == 0 || dataset.size() == 0)
+    {
+        throw std::invalid_argument("Error: Evaluation needs a non-empty dataset and a batch size of at least 1");
+    }
+
+    batch_size = std::min(batch_size, dataset.size());
+    Matrix batch(dataset.features(), batch_size);
+    std::vector<size_t> labels(batch_size);
+
+    const size_t training_correct = correct_predictions;
+    const double training_loss = accumulated_loss;
+    reset_epoch_metrics();
+
+    for (size_t start = 0; start < dataset.size(); start += batch_size)
+    {
+        const size_t count = std::min(batch_size, dataset.size() - start);
+
+        MatrixView input(batch.data(), batch.rows(), count);
+        dataset.get_batch(start, input);
+        for (size_t j = 0; j < count; j++)
+        {
+            labels[j] = dataset.get_output(start + j);
+        }
+
+        forward(input);
+
+        const Matrix& pred = layers.back().getA();
+        accumulate_loss(pred, labels.data());
+        compute_accuracy(pred, labels.data());
+    }
+
+    const double result = static_cast<double>(correct_predictions) / dataset.size();
+    loss = accumulated_loss / dataset.size();
+
+    correct_predictions = training_correct;
+    accumulated_loss = training_loss;
+
+    return result;
+}
+
+constexpr size_t Network::PREDICT_CHUNK;
+
+template <class Gather, class Store>
+void Network::predict_chunks(size_t samples, Gather&& gather, Store&& store) const
+{
+    if (samples == 0) return;
+
+    const size_t features = layers[0].get_input_size();
+    const size_t chunk = std::min(PREDICT_CHUNK, samples);
+    const size_t chunks = (samples + chunk - 1) / chunk;
+    const size_t workers = std::min(num_threads, chunks);
+
+    std::vector<InferenceSession> sessions;
+    sessions.reserve(workers);
+    for (size_t r = 0; r < workers; r++)
+    {
+        sessions.emplace_back(*this, chunk);
+    }
+    std::vector<Matrix> inputs(workers, Matrix(features, chunk));
+    std::atomic<size_t> next_chunk{0};
+
+    ThreadPool::global().parallel_for(workers, [&](size_t r)
+    {
+        for (size_t c = next_chunk.fetch_add(1, std::memory_order_relaxed);
+             c < chunks;
+             c = next_chunk.fetch_add(1, std::memory_order_relaxed))
+        {
+            const size_t first = c * chunk;
+            const size_t count = std::min(chunk, samples - first);
+
+            MatrixView input(inputs[r].data(), features, count);
+            gather(first, input);
+
+            store(sessions[r].forward(input), first);
+        }
+    });
+}
+
+static void check_features(size_t features, size_t expected)
+{
+    if (features != expected)
+    {
+        throw std::invalid_argument(
+            "Error: Inputs have " + std::to_string(features) + " features, the network expects " +
+            std::to_string(expected)
+        );
+    }
+}
+
+// Inputs hold one sample per row; chunks are transposed into the
+// features x batch layout forward() takes
+static void gather_rows(ConstMatrixView inputs, size_t first, MatrixView out)
+{
+    for (size_t j = 0; j < out.cols(); j++)
+    {
+        const Scalar* sample = inputs.row_data(first + j);
+        for (size_t f = 0; f < out.rows(); f++)
+        {
+            out.set(f, j, sample[f]);
         }
     }
 }
 
-void Network::accumulate_loss(const Matrix& prediction, size_t label)
+std::vector<size_t> Network::predict_batch(ConstMatrixView inputs) const
+{
+    check_features(inputs.cols(), layers[0].get_input_size());
+
+    std::vector<size_t> labels(inputs.rows());
+    predict_chunks(inputs.rows(),
+        [&](size_t first, MatrixView out) { gather_rows(inputs, first, out); },
+        [&](ConstMatrixView output, size_t first)
+        {
+            for (size_t j = 0; j < output.cols(); j++) labels[first + j] = argmax(output, j);
+        });
+    return labels;
+}
+
+std::vector<size_t> Network::predict_batch(const Dataset& dataset) const
 {
+    check_features(dataset.features(), layers[0].get_input_size());
+
+    std::vector<size_t> labels(dataset.size());
+    predict_chunks(dataset.size(),
+        [&](size_t first, MatrixView out) { dataset.get_batch(first, out); },
+        [&](ConstMatrixView output, size_t first)
+        {
+            for (size_t j = 0; j < output.cols(); j++) labels[first + j] = argmax(output, j);
+        });
+    return labels;
+}
+
+Matrix Network::predict_proba_batch(ConstMatrixView inputs) const
+{
+    check_features(inputs.cols(), layers[0].get_input_size());
+
+    Matrix probabilities(inputs.rows(), layers.back().get_output_size());
+    predict_chunks(inputs.rows(),
+        [&](size_t first, MatrixView out) { gather_rows(inputs, first, out); },
+        [&](ConstMatrixView output, size_t first)
+        {
+            Matrix::transpose_into(MatrixView(probabilities).block(first, 0, output.cols(), output.rows()), output);
+        });
+    return probabilities;
+}
+
+Matrix Network::predict_proba_batch(const Dataset& dataset) const
+{
+    check_features(dataset.features(), layers[0].get_input_size());
+
+    Matrix probabilities(dataset.size(), layers.back().get_output_size());
+    predict_chunks(dataset.size(),
+        [&](size_t first, MatrixView out) { dataset.get_batch(first, out); },
+        [&](ConstMatrixView output, size_t first)
+        {
+            Matrix::transpose_into(MatrixView(probabilities).block(first, 0, output.cols(), output.rows()), output);
+        });
+    return probabilities;
+}
+
+void Network::forward(ConstMatrixView input)
+{
+    set_batch(input.cols());
+    layers[0].set_prev_A(input);
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        layers[i].forward(); 
+    }
+}
+
+void Network::backprop(size_t label)
+{
+    backprop(&label);
+}
+
+void Network::backprop(const size_t* labels)
+{
+    loss_gradient(labels);
+
+    for (size_t i = layers.size(); i-- > 0; )
+    {
+        layers[i].backprop();
+    }
+}
+
+void Network::loss_gradient(size_t label)
+{
+    loss_gradient(&label);
+}
+
+void Network::loss_gradient(const size_t* labels)
+{
+    const Matrix& prediction = layers.back().getA();
+    Matrix& dZ = layers.back().get_dZ();
+
+    dZ = prediction;
+    for (size_t j = 0; j < dZ.cols(); j++)
+    {
+        dZ.set(labels[j], j, dZ.get(labels[j], j) - 1.0);
+    }
+
     switch (loss_type)
     {
         case Loss::CROSS_ENTROPY:
-        {
-            double pred_prob = prediction.get(label, 0);
-            if (pred_prob < 1e-10) pred_prob = 1e-10; // Avoid log(0)
-            accumulated_loss += -std::log(pred_prob);
             break;
-        }
         case Loss::MSE:
+            dZ *= 2.0;
+            break;
+    }
+}
+
+void Network::accumulate_loss(ConstMatrixView prediction, size_t label)
+{
+    accumulate_loss(prediction, &label);
+}
+
+void Network::accumulate_loss(ConstMatrixView prediction, const size_t* labels)
+{
+    for (size_t j = 0; j < prediction.cols(); j++)
+    {
+        const size_t label = labels[j];
+
+        switch (loss_type)
         {
-            // Create target vector (one-hot encoding)
-            Matrix target(prediction.rows(), 1);
-            target.fill(0.0);
-            target.set(label, 0, 1.0);
-            
-            // MSE: sum of squared differences
-            Matrix diff = prediction - target;
-            double mse = 0.0;
-            for (size_t i = 0; i < diff.rows(); i++)
+            case Loss::CROSS_ENTROPY:
             {
-                double val = diff.get(i, 0);
-                mse += val * val;
+                double pred_prob = prediction.get(label, j);
+                if (pred_prob < 1e-10) pred_prob = 1e-10; // Avoid log(0)
+                accumulated_loss += -std::log(pred_prob);
+                break;
+            }
+            case Loss::MSE:
+            {
+                // MSE against the one-hot target: sum of squared differences
+                double mse = 0.0;
+                for (size_t i = 0; i < prediction.rows(); i++)
+                {
+                    double val = prediction.get(i, j) - (i == label ? 1.0 : 0.0);
+                    mse += val * val;
+                }
+                accumulated_loss += mse;
+                break;
             }
-            accumulated_loss += mse;
-            break;
         }
     }
 }
 
 void Network::step(double learning_rate)
 {
-    for (size_t i = 0; i < layers.size(); i++)
+    if (max_grad_norm > 0.0)
     {
-        layers[i].step(learning_rate, 0.9);
+        parameters.clip_gradients(max_grad_norm);
     }
+    optimizer.step(parameters, learning_rate);
 }
 
-void Network::lr_reduce_on_plateau()
+void Network::set_optimizer(const Optimizer& o)
 {
-    if (accuracy > best_accuracy + min_delta)
+    optimizer = o;
+    optimizer.set_steps(0);
+
+    if (optimizer.state_slots() != parameters.state_slots())
     {
-        best_accuracy = accuracy;
+        plan_parameters();
+    }
+    parameters.clear_state();
+    replicas.clear();
+}
+
+bool Network::lr_reduce_on_plateau()
+{
+    if (!track_plateau(accuracy)) return false;
+
+    // Written in the background; training continues with the next epoch
+    if (!checkpoints) checkpoints.reset(new CheckpointWriter());
+    checkpoints->publish(*this, "checkpoints/model.crnn");
+
+    return true;
+}
+
+bool Network::track_plateau(double score)
+{
+    if (score > best_accuracy + min_delta)
+    {
+        best_accuracy = score;
         patience_counter = 0;
-        
-        ModelIO::save_model(*this, "checkpoints/model.crnn");
-        
-        return;
+        return true;
     }
 
     patience_counter++;
@@ -189,18 +791,33 @@ void Network::lr_reduce_on_plateau()
         if (new_lr >= min_lr)
         {
             learning_rate = new_lr;            
-            best_accuracy = accuracy;
+            best_accuracy = score;
         }
         
         patience_counter = 0;
     }
+
+    return false;
 }
 
-void Network::compute_accuracy(const Matrix& prediction, size_t label)
+bool Network::track_early_stopping(bool improved)
 {
-    size_t argmax = Network::argmax(prediction);
+    stale_evaluations = improved ? 0 : stale_evaluations + 1;
+
+    return early_stopping > 0 && stale_evaluations >= early_stopping;
+}
 
-    if (argmax == label) correct_predictions++;
+void Network::compute_accuracy(ConstMatrixView prediction, size_t label)
+{
+    compute_accuracy(prediction, &label);
+}
+
+void Network::compute_accuracy(ConstMatrixView prediction, const size_t* labels)
+{
+    for (size_t j = 0; j < prediction.cols(); j++)
+    {
+        if (argmax(prediction, j) == labels[j]) correct_predictions++;
+    }
 }
 
 void Network::reset_epoch_metrics()
@@ -216,17 +833,17 @@ void Network::print_accuracy()
     std::cout << "Accuracy: " << accuracy << std::endl;
 }
 
-size_t Network::argmax(const Matrix& prediction)
+size_t Network::argmax(ConstMatrixView prediction, size_t column) const
 {
     size_t max_idx = 0;
-    double max_val = prediction.get(0, 0);
+    Scalar max_val = prediction.get(0, column);
 
     for (size_t i = 1; i < prediction.rows(); i++)
     {
-        if (prediction.get(i, 0) > max_val)
+        if (prediction.get(i, column) > max_val)
         {
             max_idx = i;
-            max_val = prediction.get(i, 0);
+            max_val = prediction.get(i, column);
         }
     }
     return max_idx;
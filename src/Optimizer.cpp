@@ -0,0 +1,93 @@
+// optimizer.cpp
+
+#include "Optimizer.hpp"
+#include "Kernels.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+Optimizer::Optimizer(OptimizerType type, double beta1, double beta2, double epsilon, double weight_decay)
+    : type(type), beta1(beta1), beta2(beta2), epsilon(epsilon), weight_decay(weight_decay)
+{
+    if (beta1 < 0.0 || beta1 >= 1.0 || beta2 < 0.0 || beta2 >= 1.0)
+    {
+        throw std::invalid_argument("Error: Optimizer decay rates must be in [0, 1)");
+    }
+    if (epsilon < 0.0 || weight_decay < 0.0)
+    {
+        throw std::invalid_argument("Error: Optimizer epsilon and weight decay must not be negative");
+    }
+}
+
+Optimizer Optimizer::sgd_momentum(double beta) { return Optimizer(OptimizerType::SGD_MOMENTUM, beta, 0.0, 0.0, 0.0); }
+Optimizer Optimizer::nesterov(double beta) { return Optimizer(OptimizerType::NESTEROV, beta, 0.0, 0.0, 0.0); }
+
+Optimizer Optimizer::adam(double beta1, double beta2, double epsilon)
+{
+    return Optimizer(OptimizerType::ADAM, beta1, beta2, epsilon, 0.0);
+}
+
+Optimizer Optimizer::adamw(double weight_decay, double beta1, double beta2, double epsilon)
+{
+    return Optimizer(OptimizerType::ADAMW, beta1, beta2, epsilon, weight_decay);
+}
+
+Optimizer Optimizer::rmsprop(double rho, double epsilon)
+{
+    return Optimizer(OptimizerType::RMSPROP, 0.0, rho, epsilon, 0.0);
+}
+
+size_t Optimizer::state_slots() const
+{
+    return type == OptimizerType::ADAM || type == OptimizerType::ADAMW ? 2 : 1;
+}
+
+void Optimizer::step(ParameterStore& store, double learning_rate)
+{
+    if (store.state_slots() < state_slots())
+    {
+        throw std::invalid_argument(
+            "Error: Optimizer needs " + std::to_string(state_slots()) + " state slots, store has " +
+            std::to_string(store.state_slots())
+        );
+    }
+
+    const kernels::KernelTable& k = kernels::active();
+    Scalar* p = store.parameters();
+    const Scalar* g = store.gradients();
+    const size_t n = store.size();
+
+    steps++;
+
+    switch (type)
+    {
+        case OptimizerType::SGD_MOMENTUM:
+            k.momentum_step(p, g, store.state(0), n, Scalar(learning_rate), Scalar(beta1));
+            break;
+
+        case OptimizerType::NESTEROV:
+            k.nesterov_step(p, g, store.state(0), n, Scalar(learning_rate), Scalar(beta1));
+            break;
+
+        case OptimizerType::ADAM:
+        case OptimizerType::ADAMW:
+        {
+            // lr * m_hat / (sqrt(v_hat) + eps) with both corrections folded
+            // into the step size and epsilon
+            const double t = static_cast<double>(steps);
+            const double correction1 = 1.0 - std::pow(beta1, t);
+            const double correction2 = std::sqrt(1.0 - std::pow(beta2, t));
+            const double step_size = learning_rate * correction2 / correction1;
+            const double decay = type == OptimizerType::ADAMW ? learning_rate * weight_decay : 0.0;
+
+            k.adam_step(p, g, store.state(0), store.state(1), n,
+                        Scalar(step_size), Scalar(beta1), Scalar(beta2),
+                        Scalar(epsilon * correction2), Scalar(decay));
+            break;
+        }
+
+        case OptimizerType::RMSPROP:
+            k.rmsprop_step(p, g, store.state(0), n, Scalar(learning_rate), Scalar(beta2), Scalar(epsilon));
+            break;
+    }
+}
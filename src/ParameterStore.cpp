@@ -0,0 +1,82 @@
+// parameterstore.cpp
+
+#include "ParameterStore.hpp"
+#include "Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+ParameterStore::ParameterStore()
+    : count(0), slots(0), params(nullptr), grads(nullptr), states(nullptr) {}
+
+ParameterStore::ParameterStore(size_t count, size_t state_slots)
+    : memory(2 * Arena::footprint(count) + Arena::footprint(count * state_slots)),
+      count(count),
+      slots(state_slots)
+{
+    params = memory.allocate(count);
+    grads = memory.allocate(count);
+    states = memory.allocate(count * state_slots);
+}
+
+void ParameterStore::share_parameters(ParameterStore& source)
+{
+    if (source.count != count)
+    {
+        throw std::invalid_argument(
+            "Error: Cannot share " + std::to_string(source.count) + " parameters with a store of " +
+            std::to_string(count)
+        );
+    }
+    params = source.params;
+}
+
+void ParameterStore::scale_gradients(Scalar factor)
+{
+    scale_gradients(factor, 0, count);
+}
+
+void ParameterStore::add_gradients(const ParameterStore& other)
+{
+    add_gradients(other, 0, count);
+}
+
+void ParameterStore::scale_gradients(Scalar factor, size_t begin, size_t end)
+{
+    kernels::active().scale(grads + begin, factor, grads + begin, end - begin);
+}
+
+void ParameterStore::add_gradients(const ParameterStore& other, size_t begin, size_t end)
+{
+    if (other.count != count)
+    {
+        throw std::invalid_argument("Error: Gradient buffers differ in size");
+    }
+    kernels::active().add(grads + begin, other.grads + begin, grads + begin, end - begin);
+}
+
+double ParameterStore::gradient_norm() const
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += double(grads[i]) * double(grads[i]);
+    }
+    return std::sqrt(sum);
+}
+
+double ParameterStore::clip_gradients(double max_norm)
+{
+    const double norm = gradient_norm();
+    if (norm > max_norm && norm > 0.0)
+    {
+        scale_gradients(Scalar(max_norm / norm));
+    }
+    return norm;
+}
+
+void ParameterStore::clear_state()
+{
+    std::fill(states, states + count * slots, Scalar(0));
+}
@@ -0,0 +1,170 @@
+// pipeline.cpp
+
+#include "Pipeline.hpp"
+#include "ThreadPool.hpp"
+#include <stdexcept>
+#include <string>
+
+Pipeline::Pipeline(size_t stage_count, size_t max_micro_batches)
+    : capacity(max_micro_batches)
+{
+    if (stage_count == 0 || max_micro_batches == 0)
+    {
+        throw std::invalid_argument("Error: Pipeline needs at least one stage and one micro-batch");
+    }
+
+    for (size_t s = 0; s < stage_count; s++)
+    {
+        stages.emplace_back(new Stage(max_micro_batches));
+    }
+    // Queues exist before any thread can reach a neighbour's
+    for (size_t s = 0; s < stage_count; s++)
+    {
+        stages[s]->thread = std::thread(&Pipeline::stage_loop, this, s);
+    }
+}
+
+Pipeline::~Pipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+
+    for (std::unique_ptr<Stage>& stage : stages)
+    {
+        stage->thread.join();
+    }
+}
+
+void Pipeline::run(size_t count, void (*fn)(void*, Phase, size_t, size_t), void* context)
+{
+    if (count == 0) return;
+    if (count > capacity)
+    {
+        throw std::invalid_argument(
+            "Error: Pipeline run of " + std::to_string(count) + " micro-batches, room for " +
+            std::to_string(capacity)
+        );
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job = fn;
+    job_context = context;
+    micro_batches = count;
+    finished = 0;
+    failed = false;
+    error = nullptr;
+    generation++;
+    start.notify_all();
+
+    done.wait(lock, [this] { return finished == stages.size(); });
+
+    if (error)
+    {
+        // Every stage is idle again; drop what the failed run left queued
+        size_t stale;
+        for (std::unique_ptr<Stage>& stage : stages)
+        {
+            while (stage->forward.try_pop(stale)) {}
+            while (stage->backward.try_pop(stale)) {}
+        }
+
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void Pipeline::stage_loop(size_t s)
+{
+    // Each stage is one core's worth of work; its products stay inline
+    ThreadPool::run_inline_on_this_thread();
+
+    uint64_t seen = 0;
+
+    for (;;)
+    {
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            count = micro_batches;
+        }
+
+        try
+        {
+            run_stage(s, count);
+        }
+        catch (...)
+        {
+            // Unblocks the other stages, which would otherwise wait on
+            // micro-batches that never arrive
+            failed = true;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (++finished == stages.size()) done.notify_one();
+    }
+}
+
+void Pipeline::run_stage(size_t s, size_t count)
+{
+    Stage& stage = *stages[s];
+    const bool first = s == 0;
+    const bool last = s + 1 == stages.size();
+
+    size_t forwarded = 0;
+    size_t returned = 0;
+
+    while (returned < count)
+    {
+        if (failed) return;
+
+        size_t m;
+        if (!last && stage.backward.try_pop(m))
+        {
+            job(job_context, Phase::Backward, s, m);
+            if (!first) hand_off(stages[s - 1]->backward, m);
+            returned++;
+        }
+        else if (forwarded < count && (first ? (m = forwarded, true) : stage.forward.try_pop(m)))
+        {
+            job(job_context, Phase::Forward, s, m);
+            forwarded++;
+
+            if (last)
+            {
+                // The loss turns around here, with the activations still hot
+                job(job_context, Phase::Backward, s, m);
+                if (!first) hand_off(stages[s - 1]->backward, m);
+                returned++;
+            }
+            else
+            {
+                hand_off(stages[s + 1]->forward, m);
+            }
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    job(job_context, Phase::Finish, s, 0);
+}
+
+void Pipeline::hand_off(SpscQueue<size_t>& queue, size_t micro_batch)
+{
+    // Queues have room for a whole run, so this does not spin in practice
+    while (!queue.try_push(micro_batch))
+    {
+        if (failed) return;
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,232 @@
+// quantizedmodel.cpp
+
+#include "QuantizedModel.hpp"
+#include "Kernels.hpp"
+#include "Matrix.hpp"
+#include "ModelIO.hpp"
+#include "Network.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+static int8_t saturate(double v)
+{
+    return static_cast<int8_t>(std::lrint(std::min(std::max(v, -127.0), 127.0)));
+}
+
+// Largest magnitude each input channel of each layer reaches over the
+// first samples rows of calibration
+static std::vector<std::vector<double>> calibrate(const Network& network, const Dataset& calibration, size_t samples)
+{
+    const std::vector<Layer>& layers = network.get_layers();
+
+    std::vector<std::vector<double>> ranges;
+    for (const Layer& layer : layers)
+    {
+        ranges.emplace_back(layer.get_input_size(), 0.0);
+    }
+
+    const size_t features = layers.front().get_input_size();
+
+    for (size_t first = 0; first < samples; first += Network::PREDICT_CHUNK)
+    {
+        const size_t count = std::min(Network::PREDICT_CHUNK, samples - first);
+
+        Matrix x(features, count);
+        for (size_t j = 0; j < count; j++)
+        {
+            const Scalar* row = calibration.sample(first + j);
+            for (size_t k = 0; k < features; k++) x.set(k, j, row[k]);
+        }
+
+        for (size_t l = 0; l < layers.size(); l++)
+        {
+            for (size_t k = 0; k < x.rows(); k++)
+            {
+                for (size_t j = 0; j < count; j++)
+                {
+                    ranges[l][k] = std::max(ranges[l][k], std::fabs(static_cast<double>(x.get(k, j))));
+                }
+            }
+
+            // The output layer's own output needs no range
+            if (l + 1 == layers.size()) break;
+
+            Matrix y(layers[l].get_output_size(), count);
+            if (layers[l].get_activation() == Activation::RELU)
+            {
+                Matrix::affine_into(y, layers[l].getW(), x, layers[l].getb(), y, gemm::Activation::Relu);
+            }
+            else
+            {
+                Matrix::affine_into(y, layers[l].getW(), x, layers[l].getb());
+            }
+            x = std::move(y);
+        }
+    }
+
+    return ranges;
+}
+
+// Channels calibration never saw away from zero keep the range [-1, 1]
+static double activation_scale(double range)
+{
+    return (range > 0.0 ? range : 1.0) / 127.0;
+}
+
+QuantizedModel::QuantizedModel(const Network& network, const Dataset& calibration, size_t samples)
+{
+    const std::vector<Layer>& source = network.get_layers();
+
+    if (calibration.features() != source.front().get_input_size())
+    {
+        throw std::invalid_argument(
+            "Error: Calibration data has " + std::to_string(calibration.features()) +
+            " features, the network expects " + std::to_string(source.front().get_input_size())
+        );
+    }
+    if (samples == 0 || samples > calibration.size()) samples = calibration.size();
+    if (samples == 0)
+    {
+        throw std::invalid_argument("Error: Quantization needs at least one calibration sample");
+    }
+
+    const std::vector<std::vector<double>> ranges = calibrate(network, calibration, samples);
+
+    std::vector<QuantizedLayer> quantized;
+    for (size_t l = 0; l < source.size(); l++)
+    {
+        const Layer& layer = source[l];
+        const size_t inputs = layer.get_input_size();
+        const size_t outputs = layer.get_output_size();
+        const bool last = l + 1 == source.size();
+
+        // W * x = (W * diag(s_x)) * (x / s_x): the input scales fold into
+        // the columns of W, then each row gets its own weight scale
+        std::vector<double> folded(outputs * inputs);
+        std::vector<double> row_scale(outputs);
+        for (size_t i = 0; i < outputs; i++)
+        {
+            double peak = 0.0;
+            for (size_t k = 0; k < inputs; k++)
+            {
+                folded[i * inputs + k] = layer.getW().get(i, k) * activation_scale(ranges[l][k]);
+                peak = std::max(peak, std::fabs(folded[i * inputs + k]));
+            }
+            row_scale[i] = peak > 0.0 ? peak / 127.0 : 1.0;
+        }
+
+        std::vector<int8_t> weights(outputs * inputs);
+        std::vector<float> scale(outputs);
+        std::vector<float> bias(outputs);
+        for (size_t i = 0; i < outputs; i++)
+        {
+            for (size_t k = 0; k < inputs; k++)
+            {
+                weights[i * inputs + k] = saturate(folded[i * inputs + k] / row_scale[i]);
+            }
+
+            // Hidden layers emit the next layer's quantized input directly;
+            // ReLU commutes with the positive rescaling
+            const double next = last ? 1.0 : activation_scale(ranges[l + 1][i]);
+            scale[i] = static_cast<float>(row_scale[i] / next);
+            bias[i] = static_cast<float>(layer.getb().get(i, 0) / next);
+        }
+
+        quantized.push_back(make_layer(inputs, outputs, layer.get_activation(), weights.data(),
+                                       std::move(scale), std::move(bias)));
+    }
+
+    std::vector<float> multipliers(source.front().get_input_size());
+    for (size_t k = 0; k < multipliers.size(); k++)
+    {
+        multipliers[k] = static_cast<float>(1.0 / activation_scale(ranges[0][k]));
+    }
+
+    *this = QuantizedModel(std::move(quantized), std::move(multipliers));
+}
+
+QuantizedModel::QuantizedModel(std::vector<QuantizedLayer> layers_param, std::vector<float> input_scale_param)
+    : layers(std::move(layers_param)), input_scale(std::move(input_scale_param))
+{
+    if (layers.empty())
+    {
+        throw std::invalid_argument("Error: Quantized model needs at least one layer");
+    }
+    if (input_scale.size() != layers.front().input_size)
+    {
+        throw std::invalid_argument("Error: Quantized model needs one input scale per feature");
+    }
+
+    for (size_t l = 0; l < layers.size(); l++)
+    {
+        if (l > 0 && layers[l].input_size != layers[l - 1].output_size)
+        {
+            throw std::invalid_argument(
+                "Error: Layer " + std::to_string(l) + " takes " + std::to_string(layers[l].input_size) +
+                " inputs, the layer before it gives " + std::to_string(layers[l - 1].output_size)
+            );
+        }
+        if (layers[l].activation == Activation::SOFTMAX && l + 1 != layers.size())
+        {
+            throw std::invalid_argument("Error: Quantized models support SOFTMAX on the output layer only");
+        }
+    }
+}
+
+QuantizedModel::QuantizedLayer QuantizedModel::make_layer(size_t input_size, size_t output_size, Activation activation,
+                                                          const int8_t* weights, std::vector<float> scale,
+                                                          std::vector<float> bias)
+{
+    QuantizedLayer layer;
+    layer.input_size = input_size;
+    layer.output_size = output_size;
+    layer.activation = activation;
+    layer.stride = kernels::quant_padded(input_size);
+
+    const size_t channels = kernels::quant_padded(output_size);
+
+    layer.weights.assign(channels * layer.stride, 0);
+    layer.row_sums.assign(channels, 0);
+    for (size_t i = 0; i < output_size; i++)
+    {
+        for (size_t k = 0; k < input_size; k++)
+        {
+            layer.weights[kernels::quant_index(i, k, layer.stride)] = weights[i * input_size + k];
+            layer.row_sums[i] += weights[i * input_size + k];
+        }
+    }
+
+    layer.scale = std::move(scale);
+    layer.bias = std::move(bias);
+    layer.scale.resize(channels, 0.0f);
+    layer.bias.resize(channels, 0.0f);
+    return layer;
+}
+
+int8_t QuantizedModel::QuantizedLayer::weight(size_t i, size_t k) const
+{
+    return weights[kernels::quant_index(i, k, stride)];
+}
+
+QuantizedModel QuantizedModel::load(const std::string& filepath)
+{
+    return ModelIO::load_quantized(filepath);
+}
+
+void QuantizedModel::save(const std::string& filepath) const
+{
+    ModelIO::save_quantized(*this, filepath);
+}
+
+size_t QuantizedModel::bytes() const
+{
+    size_t total = input_scale.size() * sizeof(float);
+    for (const QuantizedLayer& layer : layers)
+    {
+        total += layer.weights.size() + layer.row_sums.size() * sizeof(int32_t) +
+                 (layer.scale.size() + layer.bias.size()) * sizeof(float);
+    }
+    return total;
+}
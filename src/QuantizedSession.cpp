@@ -0,0 +1,119 @@
+// quantizedsession.cpp
+
+#include "QuantizedSession.hpp"
+#include "Kernels.hpp"
+#include "Matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+QuantizedSession::QuantizedSession(const QuantizedModel& model_param, size_t capacity_param)
+    : model(model_param), width(0), capacity(0)
+{
+    for (const QuantizedModel::QuantizedLayer& layer : model.get_layers())
+    {
+        width = std::max(width, layer.stride);
+    }
+
+    plan(std::max<size_t>(capacity_param, 1));
+}
+
+void QuantizedSession::plan(size_t new_capacity)
+{
+    buffers[0].assign(new_capacity * width, 0);
+    buffers[1].assign(new_capacity * width, 0);
+    output.assign(new_capacity * model.output_size(), Scalar(0));
+    capacity = new_capacity;
+}
+
+void QuantizedSession::quantize_input(ConstMatrixView input)
+{
+    const QuantizedModel::QuantizedLayer& first = model.get_layers().front();
+    const std::vector<float>& scale = model.get_input_scale();
+    int8_t* q = buffers[0].data();
+
+    for (size_t k = 0; k < input.rows(); k++)
+    {
+        const Scalar* row = input.row_data(k);
+        for (size_t j = 0; j < input.cols(); j++)
+        {
+            const float v = std::min(std::max(static_cast<float>(row[j]) * scale[k], -127.0f), 127.0f);
+            q[j * first.stride + k] = static_cast<int8_t>(std::lrint(v));
+        }
+    }
+}
+
+ConstMatrixView QuantizedSession::forward(ConstMatrixView input)
+{
+    if (input.rows() != model.input_size())
+    {
+        throw std::invalid_argument(
+            "Error: Input has " + std::to_string(input.rows()) + " features, the network expects " +
+            std::to_string(model.input_size())
+        );
+    }
+
+    const size_t batch = input.cols();
+    if (batch > capacity) plan(batch);
+
+    quantize_input(input);
+
+    const std::vector<QuantizedModel::QuantizedLayer>& layers = model.get_layers();
+    const kernels::KernelTable& table = kernels::active();
+
+    for (size_t l = 0; l < layers.size(); l++)
+    {
+        const QuantizedModel::QuantizedLayer& layer = layers[l];
+
+        kernels::QuantEpilogue epilogue;
+        epilogue.row_sums = layer.row_sums.data();
+        epilogue.scale = layer.scale.data();
+        epilogue.bias = layer.bias.data();
+        epilogue.relu = layer.activation == Activation::RELU;
+
+        if (l + 1 < layers.size())
+        {
+            epilogue.qout = buffers[(l + 1) % 2].data();
+            epilogue.ldq = layers[l + 1].stride;
+        }
+        else
+        {
+            epilogue.out = output.data();
+            epilogue.ldo = batch;
+        }
+
+        table.gemm_s8(layer.weights.data(), buffers[l % 2].data(), layer.stride,
+                      layer.output_size, batch, layer.stride, epilogue);
+    }
+
+    MatrixView result(output.data(), model.output_size(), batch);
+    if (layers.back().activation == Activation::SOFTMAX)
+    {
+        Matrix::softmax_into(result, result);
+    }
+
+    return result;
+}
+
+size_t QuantizedSession::predict(ConstMatrixView input)
+{
+    size_t label;
+    predict(input.block(0, 0, input.rows(), 1), &label);
+    return label;
+}
+
+void QuantizedSession::predict(ConstMatrixView input, size_t* labels)
+{
+    const ConstMatrixView scores = forward(input);
+
+    for (size_t j = 0; j < scores.cols(); j++)
+    {
+        size_t best = 0;
+        for (size_t i = 1; i < scores.rows(); i++)
+        {
+            if (scores.get(i, j) > scores.get(best, j)) best = i;
+        }
+        labels[j] = best;
+    }
+}
@@ -0,0 +1,542 @@
+// simdkernels.hpp
+//
+// Kernel bodies shared by every instruction set, written for Scalar
+// against a small vector-traits type S:
+//
+//     S::V, S::W                        register type and lane count
+//     load, store, set1                 unaligned memory access, broadcast
+//     add, sub, mul, div, max, min,     lane-wise arithmetic (fmadd = a*b+c);
+//     fmadd, sqrt                       max and min return b when either
+//                                       lane is NaN, as x86 does
+//     round                             round to nearest integer
+//     step                              1 where x > 0, else 0
+//     pow2n                             2^n for integral n in the normal exponent range
+//     hsum, hmax                        horizontal reductions
+//
+// The GEMM micro-kernel keeps an MR x NV-register tile of C in
+// registers; MR and NV are picked per table to fill its register file.
+//
+// The int8 product takes a second traits type Q, whose accumulator holds
+// one panel: QUANT_BLOCK int32 lanes, over however many registers.
+//
+//     Q::A, Q::NR                       panel accumulator, samples per tile
+//     zero                              empty accumulator
+//     dot(acc, x4, w)                   acc plus, for each channel, the four
+//                                       products of its weights in the packed
+//                                       group w and the four int8 in x4
+//     finish(acc, e, i, j, rows)        epilogue for channels i .. i + rows of
+//                                       sample j
+//
+// Included only by the per-ISA translation units. Everything lives in an
+// anonymous namespace so code built with -mavx2 / -mavx512f never leaks
+// into symbols shared with the rest of the program.
+
+#pragma once
+#include "Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace kernels
+{
+namespace
+{
+    constexpr size_t SOFTMAX_CHUNK = 64;
+
+    // Clamp range (keeps 2^n normal), Cody-Waite split of ln2 and Taylor
+    // degree for each element type.
+    template <class T> struct ExpConstants;
+
+    template <> struct ExpConstants<double>
+    {
+        static constexpr double lo = -708.0, hi = 709.0;
+        static constexpr double ln2_hi = 6.93145751953125e-1, ln2_lo = 1.42860682030941723212e-6;
+        static constexpr int degree = 13;
+    };
+
+    template <> struct ExpConstants<float>
+    {
+        static constexpr float lo = -87.0f, hi = 88.0f;
+        static constexpr float ln2_hi = 0.693359375f, ln2_lo = -2.12194440e-4f;
+        static constexpr int degree = 7;
+    };
+
+    constexpr double INV_FACTORIAL[] = {
+        1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0,
+        1.0 / 5040.0, 1.0 / 40320.0, 1.0 / 362880.0, 1.0 / 3628800.0,
+        1.0 / 39916800.0, 1.0 / 479001600.0, 1.0 / 6227020800.0
+    };
+
+    template <class S>
+    inline typename S::V vexp(typename S::V x)
+    {
+        using V = typename S::V;
+        using C = ExpConstants<Scalar>;
+
+        // x second, so a NaN passes through the clamp
+        x = S::min(S::set1(C::hi), S::max(S::set1(C::lo), x));
+
+        // x = n * ln2 + r, |r| <= ln2 / 2
+        const V n = S::round(S::mul(x, S::set1(Scalar(1.4426950408889634))));
+        V r = S::fmadd(n, S::set1(-C::ln2_hi), x);
+        r = S::fmadd(n, S::set1(-C::ln2_lo), r);
+
+        // Taylor series of e^r, Horner form
+        V p = S::set1(Scalar(INV_FACTORIAL[C::degree]));
+        for (int k = C::degree - 1; k >= 0; k--)
+        {
+            p = S::fmadd(p, r, S::set1(Scalar(INV_FACTORIAL[k])));
+        }
+
+        return S::mul(p, S::pow2n(n));
+    }
+
+    template <class S>
+    void add(const Scalar* a, const Scalar* b, Scalar* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::add(S::load(a + i), S::load(b + i)));
+        for (; i < n; i++) out[i] = a[i] + b[i];
+    }
+
+    template <class S>
+    void sub(const Scalar* a, const Scalar* b, Scalar* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::sub(S::load(a + i), S::load(b + i)));
+        for (; i < n; i++) out[i] = a[i] - b[i];
+    }
+
+    template <class S>
+    void mul(const Scalar* a, const Scalar* b, Scalar* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::mul(S::load(a + i), S::load(b + i)));
+        for (; i < n; i++) out[i] = a[i] * b[i];
+    }
+
+    template <class S>
+    void scale(const Scalar* a, Scalar s, Scalar* out, size_t n)
+    {
+        const typename S::V vs = S::set1(s);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::mul(S::load(a + i), vs));
+        for (; i < n; i++) out[i] = a[i] * s;
+    }
+
+    template <class S>
+    void axpy(Scalar alpha, const Scalar* x, Scalar* y, size_t n)
+    {
+        const typename S::V va = S::set1(alpha);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(y + i, S::fmadd(va, S::load(x + i), S::load(y + i)));
+        for (; i < n; i++) y[i] += alpha * x[i];
+    }
+
+    template <class S>
+    void relu(const Scalar* a, Scalar* out, size_t n)
+    {
+        const typename S::V zero = S::set1(0.0);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::max(zero, S::load(a + i)));
+        for (; i < n; i++) out[i] = a[i] < 0 ? 0 : a[i];
+    }
+
+    template <class S>
+    void drelu(const Scalar* a, Scalar* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::step(S::load(a + i)));
+        for (; i < n; i++) out[i] = a[i] > 0 ? 1 : 0;
+    }
+
+    // ReLU backward: out[i] = grad[i] where a[i] > 0, else 0, without
+    // forming the drelu mask
+    template <class S>
+    void relu_backward(const Scalar* grad, const Scalar* a, Scalar* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W) S::store(out + i, S::mul(S::load(grad + i), S::step(S::load(a + i))));
+        for (; i < n; i++) out[i] = grad[i] * (a[i] > 0 ? 1 : 0);
+    }
+
+    // out[i] = exp(a[i] - shift[i]); shift may be null. The tail goes
+    // through a padded register so results do not depend on position.
+    template <class S>
+    void exp_shifted(const Scalar* a, const Scalar* shift, Scalar* out, size_t n)
+    {
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W)
+        {
+            typename S::V x = S::load(a + i);
+            if (shift) x = S::sub(x, S::load(shift + i));
+            S::store(out + i, vexp<S>(x));
+        }
+
+        if (i < n)
+        {
+            Scalar buf[S::W] = {};
+            for (size_t t = 0; t < n - i; t++) buf[t] = shift ? a[i + t] - shift[i + t] : a[i + t];
+            S::store(buf, vexp<S>(S::load(buf)));
+            for (size_t t = 0; t < n - i; t++) out[i + t] = buf[t];
+        }
+    }
+
+    template <class S>
+    void exp(const Scalar* a, Scalar* out, size_t n)
+    {
+        exp_shifted<S>(a, nullptr, out, n);
+    }
+
+    // Softmax of a contiguous vector.
+    template <class S>
+    void softmax_vector(const Scalar* in, Scalar* out, size_t n)
+    {
+        using V = typename S::V;
+
+        Scalar max_val = in[0];
+        size_t i = 0;
+        if (n >= S::W)
+        {
+            V vmax = S::load(in);
+            for (i = S::W; i + S::W <= n; i += S::W) vmax = S::max(vmax, S::load(in + i));
+            max_val = S::hmax(vmax);
+        }
+        for (; i < n; i++) if (in[i] > max_val) max_val = in[i];
+
+        const V vshift = S::set1(max_val);
+        V vsum = S::set1(0.0);
+        Scalar sum = 0.0;
+        for (i = 0; i + S::W <= n; i += S::W)
+        {
+            const V e = vexp<S>(S::sub(S::load(in + i), vshift));
+            S::store(out + i, e);
+            vsum = S::add(vsum, e);
+        }
+        if (i < n)
+        {
+            Scalar buf[S::W] = {};
+            for (size_t t = 0; t < n - i; t++) buf[t] = in[i + t] - max_val;
+            S::store(buf, vexp<S>(S::load(buf)));
+            for (size_t t = 0; t < n - i; t++)
+            {
+                out[i + t] = buf[t];
+                sum += buf[t];
+            }
+        }
+        sum += S::hsum(vsum);
+
+        if (sum != 0.0) scale<S>(out, 1.0 / sum, out, n);
+    }
+
+    // Column-wise softmax of a row-major matrix: columns are processed in
+    // chunks, vectorizing across the columns of each row.
+    template <class S>
+    void softmax(const Scalar* in, size_t ld_in, Scalar* out, size_t ld_out, size_t rows, size_t cols)
+    {
+        if (rows == 0 || cols == 0) return;
+
+        if (cols == 1 && ld_in == 1 && ld_out == 1)
+        {
+            softmax_vector<S>(in, out, rows);
+            return;
+        }
+
+        Scalar max_val[SOFTMAX_CHUNK];
+        Scalar sum[SOFTMAX_CHUNK];
+
+        for (size_t c0 = 0; c0 < cols; c0 += SOFTMAX_CHUNK)
+        {
+            const size_t width = cols - c0 < SOFTMAX_CHUNK ? cols - c0 : SOFTMAX_CHUNK;
+
+            for (size_t c = 0; c < width; c++)
+            {
+                max_val[c] = in[c0 + c];
+                sum[c] = 0.0;
+            }
+
+            for (size_t r = 1; r < rows; r++)
+            {
+                const Scalar* row = in + r * ld_in + c0;
+                size_t c = 0;
+                for (; c + S::W <= width; c += S::W)
+                {
+                    S::store(max_val + c, S::max(S::load(max_val + c), S::load(row + c)));
+                }
+                for (; c < width; c++) if (row[c] > max_val[c]) max_val[c] = row[c];
+            }
+
+            for (size_t r = 0; r < rows; r++)
+            {
+                exp_shifted<S>(in + r * ld_in + c0, max_val, out + r * ld_out + c0, width);
+                add<S>(sum, out + r * ld_out + c0, sum, width);
+            }
+
+            for (size_t c = 0; c < width; c++) sum[c] = sum[c] != 0.0 ? 1.0 / sum[c] : 1.0;
+
+            for (size_t r = 0; r < rows; r++)
+            {
+                mul<S>(out + r * ld_out + c0, sum, out + r * ld_out + c0, width);
+            }
+        }
+    }
+
+    // Optimizer updates: one pass over the flat parameter, gradient and
+    // state buffers of a ParameterStore.
+
+    // v = beta * v + (1 - beta) * g; p -= lr * v
+    template <class S>
+    void momentum_step(Scalar* p, const Scalar* g, Scalar* v, size_t n, Scalar lr, Scalar beta)
+    {
+        using V = typename S::V;
+        const V keep = S::set1(beta), blend = S::set1(Scalar(1) - beta), rate = S::set1(lr);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W)
+        {
+            const V vel = S::add(S::mul(S::load(v + i), keep), S::mul(S::load(g + i), blend));
+            S::store(v + i, vel);
+            S::store(p + i, S::sub(S::load(p + i), S::mul(vel, rate)));
+        }
+        for (; i < n; i++)
+        {
+            v[i] = v[i] * beta + g[i] * (Scalar(1) - beta);
+            p[i] -= v[i] * lr;
+        }
+    }
+
+    // Momentum evaluated one step ahead: p -= lr * (beta * v + (1 - beta) * g)
+    // with v already updated
+    template <class S>
+    void nesterov_step(Scalar* p, const Scalar* g, Scalar* v, size_t n, Scalar lr, Scalar beta)
+    {
+        using V = typename S::V;
+        const V keep = S::set1(beta), blend = S::set1(Scalar(1) - beta), rate = S::set1(lr);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W)
+        {
+            const V grad = S::mul(S::load(g + i), blend);
+            const V vel = S::fmadd(S::load(v + i), keep, grad);
+            S::store(v + i, vel);
+            S::store(p + i, S::sub(S::load(p + i), S::mul(S::fmadd(vel, keep, grad), rate)));
+        }
+        for (; i < n; i++)
+        {
+            const Scalar grad = g[i] * (Scalar(1) - beta);
+            v[i] = v[i] * beta + grad;
+            p[i] -= (v[i] * beta + grad) * lr;
+        }
+    }
+
+    // m and v are the first and second moment estimates. step_size and
+    // epsilon already carry the bias corrections; decay (lr * weight
+    // decay, AdamW) shrinks p independently of the gradient.
+    template <class S>
+    void adam_step(Scalar* p, const Scalar* g, Scalar* m, Scalar* v, size_t n,
+                   Scalar step_size, Scalar beta1, Scalar beta2, Scalar epsilon, Scalar decay)
+    {
+        using V = typename S::V;
+        const V b1 = S::set1(beta1), c1 = S::set1(Scalar(1) - beta1);
+        const V b2 = S::set1(beta2), c2 = S::set1(Scalar(1) - beta2);
+        const V rate = S::set1(step_size), eps = S::set1(epsilon), shrink = S::set1(Scalar(1) - decay);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W)
+        {
+            const V grad = S::load(g + i);
+            const V mean = S::fmadd(S::load(m + i), b1, S::mul(grad, c1));
+            const V var = S::fmadd(S::load(v + i), b2, S::mul(S::mul(grad, grad), c2));
+            S::store(m + i, mean);
+            S::store(v + i, var);
+
+            const V update = S::div(S::mul(mean, rate), S::add(S::sqrt(var), eps));
+            S::store(p + i, S::sub(S::mul(S::load(p + i), shrink), update));
+        }
+        for (; i < n; i++)
+        {
+            m[i] = m[i] * beta1 + g[i] * (Scalar(1) - beta1);
+            v[i] = v[i] * beta2 + g[i] * g[i] * (Scalar(1) - beta2);
+            p[i] = p[i] * (Scalar(1) - decay) - m[i] * step_size / (std::sqrt(v[i]) + epsilon);
+        }
+    }
+
+    // v = rho * v + (1 - rho) * g^2; p -= lr * g / (sqrt(v) + epsilon)
+    template <class S>
+    void rmsprop_step(Scalar* p, const Scalar* g, Scalar* v, size_t n, Scalar lr, Scalar rho, Scalar epsilon)
+    {
+        using V = typename S::V;
+        const V keep = S::set1(rho), blend = S::set1(Scalar(1) - rho);
+        const V rate = S::set1(lr), eps = S::set1(epsilon);
+
+        size_t i = 0;
+        for (; i + S::W <= n; i += S::W)
+        {
+            const V grad = S::load(g + i);
+            const V var = S::fmadd(S::load(v + i), keep, S::mul(S::mul(grad, grad), blend));
+            S::store(v + i, var);
+            S::store(p + i, S::sub(S::load(p + i), S::div(S::mul(grad, rate), S::add(S::sqrt(var), eps))));
+        }
+        for (; i < n; i++)
+        {
+            v[i] = v[i] * rho + g[i] * g[i] * (Scalar(1) - rho);
+            p[i] -= g[i] * lr / (std::sqrt(v[i]) + epsilon);
+        }
+    }
+
+    inline int8_t saturate_s8(float v)
+    {
+        return static_cast<int8_t>(std::lrint(std::min(std::max(v, -127.0f), 127.0f)));
+    }
+
+    // Stores dequantized values v of channels i .. i + rows of sample j. A
+    // requantized panel is written whole; the next product's padding
+    // absorbs channels past rows.
+    inline void store_s8(const float* v, const QuantEpilogue& e, size_t i, size_t j, size_t rows)
+    {
+        if (e.qout)
+        {
+            int8_t* q = e.qout + j * e.ldq + i;
+            for (size_t r = 0; r < QUANT_BLOCK; r++) q[r] = saturate_s8(v[r]);
+            return;
+        }
+
+        for (size_t r = 0; r < rows; r++)
+        {
+            e.out[(i + r) * e.ldo + j] = static_cast<Scalar>(v[r]);
+        }
+    }
+
+    // The whole epilogue one lane at a time, for tables without a vector one
+    inline void finish_lanes(const int32_t* acc, int32_t offset, const QuantEpilogue& e,
+                             size_t i, size_t j, size_t rows)
+    {
+        float v[QUANT_BLOCK];
+        for (size_t r = 0; r < QUANT_BLOCK; r++)
+        {
+            v[r] = e.scale[i + r] * static_cast<float>(acc[r] - offset * e.row_sums[i + r]) + e.bias[i + r];
+            if (e.relu && v[r] < 0.0f) v[r] = 0.0f;
+        }
+        store_s8(v, e, i, j, rows);
+    }
+
+    template <class Q, size_t NR>
+    void panel_s8(const int8_t* panel, const int8_t* X, size_t ldx, size_t i, size_t j, size_t rows,
+                  size_t K, const QuantEpilogue& e)
+    {
+        typename Q::A acc[NR];
+        for (size_t c = 0; c < NR; c++) acc[c] = Q::zero();
+
+        for (size_t k = 0; k < K; k += 4)
+        {
+            const int8_t* w = panel + k * QUANT_BLOCK;
+            for (size_t c = 0; c < NR; c++)
+            {
+                int32_t x4;
+                std::memcpy(&x4, X + (j + c) * ldx + k, sizeof(x4));
+                acc[c] = Q::dot(acc[c], x4, w);
+            }
+        }
+
+        for (size_t c = 0; c < NR; c++)
+        {
+            Q::finish(acc[c], e, i, j + c, rows);
+        }
+    }
+
+    // Each group of weights loaded is used for Q::NR samples; a panel's
+    // weights (QUANT_BLOCK * K bytes) stay in L1 across the tiles
+    template <class Q>
+    void gemm_s8(const int8_t* W, const int8_t* X, size_t ldx,
+                 size_t M, size_t N, size_t K, const QuantEpilogue& e)
+    {
+        size_t j = 0;
+        for (; j + Q::NR <= N; j += Q::NR)
+        {
+            for (size_t i = 0; i < M; i += QUANT_BLOCK)
+            {
+                panel_s8<Q, Q::NR>(W + i * K, X, ldx, i, j, std::min(QUANT_BLOCK, M - i), K, e);
+            }
+        }
+        for (; j < N; j++)
+        {
+            for (size_t i = 0; i < M; i += QUANT_BLOCK)
+            {
+                panel_s8<Q, 1>(W + i * K, X, ldx, i, j, std::min(QUANT_BLOCK, M - i), K, e);
+            }
+        }
+    }
+
+    // One broadcast of A and NV loads of B feed MR * NV fused multiply-adds
+    // per step; the accumulators stay in registers for the whole of kc
+    template <class S, size_t MR, size_t NV>
+    void gemm_micro(size_t kc, const Scalar* Ap, const Scalar* Bp, Scalar beta, Scalar* C, size_t ldc)
+    {
+        using V = typename S::V;
+        constexpr size_t NR = NV * S::W;
+
+        V acc[MR][NV];
+        for (size_t r = 0; r < MR; r++)
+        {
+            for (size_t v = 0; v < NV; v++) acc[r][v] = S::set1(0.0);
+        }
+
+        for (size_t k = 0; k < kc; k++)
+        {
+            V b[NV];
+            for (size_t v = 0; v < NV; v++) b[v] = S::load(Bp + v * S::W);
+
+            for (size_t r = 0; r < MR; r++)
+            {
+                const V a = S::set1(Ap[r]);
+                for (size_t v = 0; v < NV; v++) acc[r][v] = S::fmadd(a, b[v], acc[r][v]);
+            }
+
+            Ap += MR;
+            Bp += NR;
+        }
+
+        const V vbeta = S::set1(beta);
+        for (size_t r = 0; r < MR; r++)
+        {
+            Scalar* c_row = C + r * ldc;
+            for (size_t v = 0; v < NV; v++)
+            {
+                Scalar* c = c_row + v * S::W;
+                if (beta == 0.0) S::store(c, acc[r][v]);
+                else if (beta == 1.0) S::store(c, S::add(S::load(c), acc[r][v]));
+                else S::store(c, S::fmadd(S::load(c), vbeta, acc[r][v]));
+            }
+        }
+    }
+
+    template <class S, size_t MR, size_t NV>
+    KernelTable make_table(const char* name, decltype(KernelTable::gemm_s8) gemm_s8)
+    {
+        static_assert(MR * NV * S::W <= GEMM_TILE_MAX, "GEMM tile too large");
+
+        KernelTable table;
+        table.name = name;
+        table.add = &add<S>;
+        table.sub = &sub<S>;
+        table.mul = &mul<S>;
+        table.scale = &scale<S>;
+        table.axpy = &axpy<S>;
+        table.relu = &relu<S>;
+        table.drelu = &drelu<S>;
+        table.relu_backward = &relu_backward<S>;
+        table.exp = &exp<S>;
+        table.softmax = &softmax<S>;
+        table.momentum_step = &momentum_step<S>;
+        table.nesterov_step = &nesterov_step<S>;
+        table.adam_step = &adam_step<S>;
+        table.rmsprop_step = &rmsprop_step<S>;
+        table.gemm_s8 = gemm_s8;
+        table.gemm = { MR, NV * S::W, &gemm_micro<S, MR, NV> };
+        return table;
+    }
+}
+}
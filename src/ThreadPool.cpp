@@ -0,0 +1,165 @@
+// threadpool.cpp
+
+#include "ThreadPool.hpp"
+#include <cstdlib>
+
+namespace
+{
+    // Set on pool workers, and on a caller while it runs its own loop
+    thread_local bool in_pool = false;
+
+    size_t default_threads()
+    {
+        if (const char* env = std::getenv("CRNN_THREADS"))
+        {
+            const long requested = std::strtol(env, nullptr, 10);
+            if (requested > 0) return static_cast<size_t>(requested);
+        }
+
+        const unsigned hardware = std::thread::hardware_concurrency();
+        return hardware > 0 ? hardware : 1;
+    }
+}
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    start(threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool(default_threads());
+    return pool;
+}
+
+void ThreadPool::run_inline_on_this_thread()
+{
+    in_pool = true;
+}
+
+void ThreadPool::start(size_t threads)
+{
+    stopping = false;
+    for (size_t i = 1; i < threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this, generation);
+    }
+    thread_count = workers.size() + 1;
+}
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    thread_count = 1;
+}
+
+void ThreadPool::resize(size_t threads)
+{
+    std::lock_guard<std::mutex> lock(submit_mutex);
+
+    if (threads == 0) threads = 1;
+    if (threads == size()) return;
+
+    stop();
+    start(threads);
+}
+
+void ThreadPool::worker_loop(uint64_t seen)
+{
+    in_pool = true;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        drain();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::drain()
+{
+    for (size_t i = next_index.fetch_add(1); i < job_size; i = next_index.fetch_add(1))
+    {
+        try
+        {
+            job(job_context, i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::run(size_t count, void (*fn)(void*, size_t), void* context)
+{
+    if (count == 0) return;
+
+    // workers is only read with submit_mutex held, since resize replaces it
+    bool parallel = count > 1 && !in_pool && submit_mutex.try_lock();
+    if (parallel && workers.empty())
+    {
+        submit_mutex.unlock();
+        parallel = false;
+    }
+
+    if (!parallel)
+    {
+        for (size_t i = 0; i < count; i++) fn(context, i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(submit_mutex, std::adopt_lock);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = fn;
+        job_context = context;
+        job_size = count;
+        next_index = 0;
+        active = workers.size();
+        error = nullptr;
+        generation++;
+    }
+    wake.notify_all();
+
+    in_pool = true;
+    drain();
+    in_pool = false;
+
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return active == 0; });
+        failure = error;
+        error = nullptr;
+    }
+
+    if (failure) std::rethrow_exception(failure);
+}
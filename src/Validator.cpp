@@ -0,0 +1,148 @@
+// validator.cpp
+
+#include "Validator.hpp"
+#include "Network.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+Validator::Validator(const Network& network, const Dataset& dataset,
+                     const std::string& checkpoint_path, size_t batch_size)
+    : dataset(dataset),
+      batch_size(batch_size),
+      checkpoint_path(checkpoint_path),
+      min_delta(network.get_min_delta()),
+      best_accuracy(network.get_best_accuracy()),
+      evaluator(new Network(network.get_layers(), network.get_learning_rate(),
+                            InitType::Zero, network.get_loss_type()))
+{
+    if (batch_size == 0 || dataset.size() == 0)
+    {
+        throw std::invalid_argument("Error: Validation needs a non-empty dataset and a batch size of at least 1");
+    }
+    if (dataset.features() != network.get_layers().front().get_input_size())
+    {
+        throw std::invalid_argument("Error: Validation dataset has " + std::to_string(dataset.features()) +
+                                    " features, the network expects " +
+                                    std::to_string(network.get_layers().front().get_input_size()));
+    }
+
+    evaluator->reserve_batch(std::min(batch_size, dataset.size()));
+    thread = std::thread(&Validator::run, this);
+}
+
+Validator::~Validator()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void Validator::submit(const Network& network, size_t epoch)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rethrow_error();
+
+    ModelIO::capture(network, buffers[spare]);
+    epochs[spare] = epoch;
+    pending = true;
+
+    wake.notify_one();
+}
+
+bool Validator::poll(Result& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rethrow_error();
+
+    if (results.empty()) return false;
+
+    result = results.front();
+    results.pop_front();
+    return true;
+}
+
+void Validator::finish()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return !pending && !evaluating; });
+    rethrow_error();
+}
+
+void Validator::rethrow_error()
+{
+    if (error)
+    {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void Validator::run()
+{
+    // Inference here must not take the shared pool from the trainer
+    ThreadPool::run_inline_on_this_thread();
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        wake.wait(lock, [this] { return pending || stopping; });
+        if (!pending) break;
+
+        const size_t current = spare;
+        spare = 1 - spare;
+        pending = false;
+        evaluating = true;
+
+        lock.unlock();
+        std::exception_ptr failure;
+        Result result;
+        try
+        {
+            result = evaluate(buffers[current], epochs[current]);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+        lock.lock();
+
+        if (failure)
+        {
+            error = failure;
+        }
+        else
+        {
+            results.push_back(result);
+        }
+        evaluating = false;
+        idle.notify_all();
+    }
+}
+
+Validator::Result Validator::evaluate(ModelIO::Snapshot& snapshot, size_t epoch)
+{
+    ParameterStore& parameters = evaluator->get_parameters();
+    std::copy(snapshot.parameters.begin(), snapshot.parameters.end(), parameters.parameters());
+
+    Result result;
+    result.epoch = epoch;
+    result.accuracy = evaluator->evaluate(dataset, batch_size, result.loss);
+    result.improved = result.accuracy > best_accuracy + min_delta;
+
+    if (result.improved)
+    {
+        best_accuracy = result.accuracy;
+
+        // The checkpoint records the accuracy it was selected by
+        snapshot.best_accuracy = result.accuracy;
+        ModelIO::write_snapshot(snapshot, checkpoint_path);
+    }
+
+    return result;
+}